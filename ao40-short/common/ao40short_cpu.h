@@ -0,0 +1,44 @@
+#ifndef AO40SHORT_CPU_H
+#define AO40SHORT_CPU_H
+
+/*
+ * CPU feature level of the AO-40 short frame kernels, shared by the encoder
+ * and the decoder
+ *
+ * The level is picked once at startup: the best one the running CPU
+ * supports, or the one the AO40SHORT_KERNEL environment variable names
+ * (scalar, sse2, ssse3, avx2, avx512bw). ao40short_set_kernel() pins it,
+ * e.g. for A/B benchmarks. The decoder kernel sets of ao40short_dispatch.h
+ * and the batch encoder both follow it. Switch levels only while no frame
+ * is being encoded or decoded.
+ */
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AO40SHORT_X86_KERNELS
+#define AO40SHORT_TARGET(isa) __attribute__ ((target (isa)))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef enum {
+  AO40SHORT_KERNEL_AUTO = -1,
+  AO40SHORT_KERNEL_SCALAR = 0,
+  AO40SHORT_KERNEL_SSE2,
+  AO40SHORT_KERNEL_SSSE3,
+  AO40SHORT_KERNEL_AVX2,
+  AO40SHORT_KERNEL_AVX512BW,
+  AO40SHORT_KERNEL_COUNT
+} ao40short_kernel_t;
+
+ao40short_kernel_t ao40short_cpu_kernel(void);     // best level supported by this CPU
+ao40short_kernel_t ao40short_get_kernel(void);     // active level
+int ao40short_set_kernel(ao40short_kernel_t kernel); // 0 on success, -1 if the CPU lacks it
+const char *ao40short_kernel_name(ao40short_kernel_t kernel);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40SHORT_CPU_H */
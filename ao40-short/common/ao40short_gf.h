@@ -0,0 +1,103 @@
+#ifndef AO40SHORT_GF_H
+#define AO40SHORT_GF_H
+
+#include <stdint.h>
+
+/*
+ * GF(2^8) and the RS(255,223) code of the AO-40 short frame, shared by the
+ * encoder and the decoder, along with the scrambler sequence both apply.
+ *
+ * Everything derives from the parameters below: ao40short_gf.c holds the
+ * tables built from AO40SHORT_GF_POLY and the generator polynomial from
+ * AO40SHORT_FCR and AO40SHORT_PRIM as const initializers, written by
+ * ao40short_gf_gen.py. Change them there as well and run it again. The RS
+ * words are shortened by AO40SHORT_PAD leading zeros.
+ */
+
+#define AO40SHORT_GF_POLY 0x187  // x^8 + x^7 + x^2 + x + 1
+#define AO40SHORT_NN      255    // GF(2^8-1)
+#define AO40SHORT_NROOTS   32
+#define AO40SHORT_FCR     112    // first consecutive root, in powers of alpha^PRIM
+#define AO40SHORT_PRIM     11    // primitive element alpha^PRIM
+#define AO40SHORT_IPRIM   116    // AO40SHORT_PRIM^-1 mod AO40SHORT_NN
+#define AO40SHORT_PAD      95
+#define AO40SHORT_A0     (AO40SHORT_NN)  // log of zero
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/* Antilog with AO40SHORT_ALPHA_TO[AO40SHORT_A0] = 0, and log with
+ * AO40SHORT_INDEX_OF[0] = AO40SHORT_A0 */
+extern const uint8_t AO40SHORT_ALPHA_TO[AO40SHORT_NN+1];
+extern const uint8_t AO40SHORT_INDEX_OF[AO40SHORT_NN+1];
+
+/* Antilog of a sum of two logs without reducing it mod AO40SHORT_NN first:
+ * AO40SHORT_ALPHA_TO_X[a+b] for any a, b < AO40SHORT_NN */
+extern const uint8_t AO40SHORT_ALPHA_TO_X[2*AO40SHORT_NN];
+
+/* Generator polynomial in index-form, AO40SHORT_RS_GENPOLY[i] the x^i term */
+extern const uint8_t AO40SHORT_RS_GENPOLY[AO40SHORT_NROOTS+1];
+
+/* A root z of z^2 + z = c, the other one is z^1; 0 if there is none */
+extern const uint8_t AO40SHORT_QUAD_ROOT[AO40SHORT_NN+1];
+
+/* With AO40SHORT_GF_MUL_TABLE defined, products and inverses in poly-form are
+ * looked up in a full 64 KB table instead of going through log and antilog.
+ * Meant for hosts with the L2 to spare; the RS encoder and decoder use it
+ * in their scalar loops. Define it for the whole build, encoder and decoder
+ * alike. AO40SHORT_GF_MUL[0][x] = 0 and AO40SHORT_GF_INV[0] = 0.
+ * The tree has no benchmark; to compare, time the same program built with
+ * and without this define (or AO40SHORT_RS_ENC_TABLE), and the SIMD syndrome
+ * kernels by pinning AO40SHORT_KERNEL. */
+#ifdef AO40SHORT_GF_MUL_TABLE
+extern const uint8_t AO40SHORT_GF_MUL[AO40SHORT_NN+1][AO40SHORT_NN+1];
+extern const uint8_t AO40SHORT_GF_INV[AO40SHORT_NN+1];
+#endif
+
+/* With AO40SHORT_RS_ENC_TABLE defined, the encoder adds the parity update of a
+ * whole feedback byte as one row of AO40SHORT_RS_ENC: 8 KB of g(x) times each
+ * feedback value, [fb][i] going to register byte i as it shifts down. */
+#ifdef AO40SHORT_RS_ENC_TABLE
+extern const uint8_t AO40SHORT_RS_ENC[AO40SHORT_NN+1][AO40SHORT_NROOTS];
+#endif
+
+/* Scrambler sequence XORed on the RS words, byte i of the frame with [i] */
+extern const uint8_t ao40short_Scrambler[320];
+
+#define AO40SHORT_MODNN(x) ao40short_mod255(x)
+
+static inline int ao40short_mod255(int x){
+  while (x >= 255) {
+    x -= 255;
+    x = (x >> 8) + (x & 255);
+  }
+  return x;
+}
+
+/* Product and quotient in poly-form, b != 0 for the quotient */
+static inline uint8_t ao40short_gf_mul(uint8_t a, uint8_t b){
+#ifdef AO40SHORT_GF_MUL_TABLE
+  return AO40SHORT_GF_MUL[a][b];
+#else
+  if (a == 0 || b == 0)
+    return 0;
+  return AO40SHORT_ALPHA_TO_X[AO40SHORT_INDEX_OF[a] + AO40SHORT_INDEX_OF[b]];
+#endif
+}
+
+static inline uint8_t ao40short_gf_div(uint8_t a, uint8_t b){
+#ifdef AO40SHORT_GF_MUL_TABLE
+  return AO40SHORT_GF_MUL[a][AO40SHORT_GF_INV[b]];
+#else
+  if (a == 0)
+    return 0;
+  return AO40SHORT_ALPHA_TO_X[AO40SHORT_INDEX_OF[a] + AO40SHORT_NN - AO40SHORT_INDEX_OF[b]];
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+#
+# Writes ao40short_gf.c: the GF(2^8) and RS tables of the AO-40 short frame
+# code and its scrambler sequence as const initializers. Run it again after
+# changing the code parameters here and in ao40short_gf.h:
+#
+#   python3 ao40short_gf_gen.py > ao40short_gf.c
+
+P = 'AO40SHORT'
+p = 'ao40short'
+TITLE = ['GF(2^8) and RS tables of the AO-40 short frame code, and its scrambler',
+         'sequence']
+
+GF_POLY = 0x187  # x^8 + x^7 + x^2 + x + 1
+NN = 255
+NROOTS = 32
+FCR = 112
+PRIM = 11
+SCRAMBLER_POLY = 0xa9  # x^8 + x^7 + x^5 + x^3 + 1, CCSDS randomizer
+SCRAMBLER_LEN = 320
+A0 = NN
+
+alpha_to = [0] * (NN + 1)
+index_of = [0] * (NN + 1)
+sr = 1
+for i in range(NN):
+    alpha_to[i] = sr
+    index_of[sr] = i
+    sr <<= 1
+    if sr & 0x100:
+        sr ^= GF_POLY
+alpha_to[A0] = 0
+index_of[0] = A0
+alpha_to_x = [alpha_to[i % NN] for i in range(2 * NN)]
+
+
+def mul(a, b):
+    if a == 0 or b == 0:
+        return 0
+    return alpha_to_x[index_of[a] + index_of[b]]
+
+
+# g(x) = (x - b^FCR) (x - b^(FCR+1)) ... with b = alpha^PRIM, poly-form
+genpoly = [1] + [0] * NROOTS
+for i in range(NROOTS):
+    root = alpha_to[((FCR + i) * PRIM) % NN]
+    for j in range(i + 1, 0, -1):
+        genpoly[j] = genpoly[j - 1] ^ mul(genpoly[j], root)
+    genpoly[0] = mul(genpoly[0], root)
+
+# z and z^1 give the same c, the smaller one is kept
+quad_root = [0] * (NN + 1)
+for z in range(NN, -1, -1):
+    quad_root[mul(z, z) ^ z] = z
+quad_root[0] = 0
+
+gf_inv = [0] + [alpha_to_x[NN - index_of[x]] for x in range(1, NN + 1)]
+
+# LFSR from all ones, shifting right, its output bit the MSB of each byte first
+scrambler = []
+sr = 0xff
+for i in range(SCRAMBLER_LEN):
+    b = 0
+    for k in range(8):
+        b = (b << 1) | (sr & 1)
+        sr = (sr >> 1) | ((bin(sr & SCRAMBLER_POLY).count('1') & 1) << 7)
+    scrambler.append(b)
+
+
+def table(v, indent='  '):
+    lines = []
+    for i in range(0, len(v), 16):
+        lines.append(indent + ' '.join('0x%02x,' % x for x in v[i:i + 16]))
+    return '\n'.join(lines)
+
+
+def rows(m):
+    return '\n'.join('  {\n%s\n  },' % table(r, '    ') for r in m)
+
+
+print('''/*
+ * %(title)s
+ *
+ * Generated by %(p)s_gf_gen.py, do not edit.
+ */
+
+#include <stdint.h>
+#include "%(p)s_gf.h"
+
+#if %(P)s_GF_POLY != 0x%(poly)x || %(P)s_NN != %(nn)d || %(P)s_NROOTS != %(nroots)d || %(P)s_FCR != %(fcr)d || %(P)s_PRIM != %(prim)d
+#error "%(p)s_gf.c does not match the parameters in %(p)s_gf.h, run %(p)s_gf_gen.py"
+#endif
+
+const uint8_t %(P)s_ALPHA_TO[%(P)s_NN+1] = {
+%(alpha_to)s
+};
+
+const uint8_t %(P)s_INDEX_OF[%(P)s_NN+1] = {
+%(index_of)s
+};
+
+const uint8_t %(P)s_ALPHA_TO_X[2*%(P)s_NN] = {
+%(alpha_to_x)s
+};
+
+const uint8_t %(P)s_RS_GENPOLY[%(P)s_NROOTS+1] = {
+%(genpoly)s
+};
+
+const uint8_t %(P)s_QUAD_ROOT[%(P)s_NN+1] = {
+%(quad_root)s
+};
+
+const uint8_t %(p)s_Scrambler[%(slen)d] = {
+%(scrambler)s
+};
+
+#ifdef %(P)s_RS_ENC_TABLE
+const uint8_t %(P)s_RS_ENC[%(P)s_NN+1][%(P)s_NROOTS] __attribute__ ((aligned (32))) = {
+%(rs_enc)s
+};
+#endif
+
+#ifdef %(P)s_GF_MUL_TABLE
+const uint8_t %(P)s_GF_INV[%(P)s_NN+1] = {
+%(gf_inv)s
+};
+
+const uint8_t %(P)s_GF_MUL[%(P)s_NN+1][%(P)s_NN+1] = {
+%(gf_mul)s
+};
+#endif''' % {
+    'P': P, 'p': p, 'title': '\n * '.join(TITLE),
+    'poly': GF_POLY, 'nn': NN, 'nroots': NROOTS, 'fcr': FCR, 'prim': PRIM,
+    'alpha_to': table(alpha_to),
+    'index_of': table(index_of),
+    'alpha_to_x': table(alpha_to_x),
+    'genpoly': table([index_of[g] for g in genpoly]),
+    'quad_root': table(quad_root),
+    'slen': SCRAMBLER_LEN,
+    'scrambler': table(scrambler),
+    'rs_enc': rows([[mul(fb, genpoly[NROOTS - 1 - j]) for j in range(NROOTS)] for fb in range(NN + 1)]),
+    'gf_inv': table(gf_inv),
+    'gf_mul': rows([[mul(a, b) for b in range(NN + 1)] for a in range(NN + 1)]),
+})
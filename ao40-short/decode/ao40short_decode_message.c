@@ -1,5 +1,5 @@
 /*
- * Viterbi encoder based on SPIRAL (http://spiral.ece.cmu.edu/vitgen/) decoder
+ * Viterbi decoder originally based on SPIRAL (http://spiral.ece.cmu.edu/vitgen/)
  * Reed-Solonom decoder is Phil Karn's work
  */
 
@@ -8,34 +8,14 @@
  * 2015, 2016
  */
 
+#define _POSIX_C_SOURCE 200112L  // posix_memalign() under -std=c99
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "ao40short_decode_message.h"
 
-const uint8_t ao40short_Scrambler[320] = {
-  0xff, 0x48, 0x0e, 0xc0, 0x9a, 0x0d, 0x70, 0xbc, 0x8e, 0x2c, 0x93, 0xad, 0xa7, 0xb7, 0x46, 0xce,
-  0x5a, 0x97, 0x7d, 0xcc, 0x32, 0xa2, 0xbf, 0x3e, 0x0a, 0x10, 0xf1, 0x88, 0x94, 0xcd, 0xea, 0xb1,
-  0xfe, 0x90, 0x1d, 0x81, 0x34, 0x1a, 0xe1, 0x79, 0x1c, 0x59, 0x27, 0x5b, 0x4f, 0x6e, 0x8d, 0x9c,
-  0xb5, 0x2e, 0xfb, 0x98, 0x65, 0x45, 0x7e, 0x7c, 0x14, 0x21, 0xe3, 0x11, 0x29, 0x9b, 0xd5, 0x63,
-  0xfd, 0x20, 0x3b, 0x02, 0x68, 0x35, 0xc2, 0xf2, 0x38, 0xb2, 0x4e, 0xb6, 0x9e, 0xdd, 0x1b, 0x39,
-  0x6a, 0x5d, 0xf7, 0x30, 0xca, 0x8a, 0xfc, 0xf8, 0x28, 0x43, 0xc6, 0x22, 0x53, 0x37, 0xaa, 0xc7,
-  0xfa, 0x40, 0x76, 0x04, 0xd0, 0x6b, 0x85, 0xe4, 0x71, 0x64, 0x9d, 0x6d, 0x3d, 0xba, 0x36, 0x72,
-  0xd4, 0xbb, 0xee, 0x61, 0x95, 0x15, 0xf9, 0xf0, 0x50, 0x87, 0x8c, 0x44, 0xa6, 0x6f, 0x55, 0x8f,
-  0xf4, 0x80, 0xec, 0x09, 0xa0, 0xd7, 0x0b, 0xc8, 0xe2, 0xc9, 0x3a, 0xda, 0x7b, 0x74, 0x6c, 0xe5,
-  0xa9, 0x77, 0xdc, 0xc3, 0x2a, 0x2b, 0xf3, 0xe0, 0xa1, 0x0f, 0x18, 0x89, 0x4c, 0xde, 0xab, 0x1f,
-  0xe9, 0x01, 0xd8, 0x13, 0x41, 0xae, 0x17, 0x91, 0xc5, 0x92, 0x75, 0xb4, 0xf6, 0xe8, 0xd9, 0xcb,
-  0x52, 0xef, 0xb9, 0x86, 0x54, 0x57, 0xe7, 0xc1, 0x42, 0x1e, 0x31, 0x12, 0x99, 0xbd, 0x56, 0x3f,
-  0xd2, 0x03, 0xb0, 0x26, 0x83, 0x5c, 0x2f, 0x23, 0x8b, 0x24, 0xeb, 0x69, 0xed, 0xd1, 0xb3, 0x96,
-  0xa5, 0xdf, 0x73, 0x0c, 0xa8, 0xaf, 0xcf, 0x82, 0x84, 0x3c, 0x62, 0x25, 0x33, 0x7a, 0xac, 0x7f,
-  0xa4, 0x07, 0x60, 0x4d, 0x06, 0xb8, 0x5e, 0x47, 0x16, 0x49, 0xd6, 0xd3, 0xdb, 0xa3, 0x67, 0x2d,
-  0x4b, 0xbe, 0xe6, 0x19, 0x51, 0x5f, 0x9f, 0x05, 0x08, 0x78, 0xc4, 0x4a, 0x66, 0xf5, 0x58, 0xff,
-  0x48, 0x0e, 0xc0, 0x9a, 0x0d, 0x70, 0xbc, 0x8e, 0x2c, 0x93, 0xad, 0xa7, 0xb7, 0x46, 0xce, 0x5a,
-  0x97, 0x7d, 0xcc, 0x32, 0xa2, 0xbf, 0x3e, 0x0a, 0x10, 0xf1, 0x88, 0x94, 0xcd, 0xea, 0xb1, 0xfe,
-  0x90, 0x1d, 0x81, 0x34, 0x1a, 0xe1, 0x79, 0x1c, 0x59, 0x27, 0x5b, 0x4f, 0x6e, 0x8d, 0x9c, 0xb5,
-  0x2e, 0xfb, 0x98, 0x65, 0x45, 0x7e, 0x7c, 0x14, 0x21, 0xe3, 0x11, 0x29, 0x9b, 0xd5, 0x63, 0xfd,
-};
-
 /* Deinterleave data:
  *
  * - The bits of every interleaved byte is spread with 80 bit distance of each
@@ -45,7 +25,7 @@ const uint8_t ao40short_Scrambler[320] = {
  *   ao40short_viterbi decoder assumes non-inverted bits, so invert every second bit
  *   by hand.
  */
-void ao40short_deinterleave(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t conv[AO40SHORT_CONV_SIZE]) {
+void ao40short_deinterleave_scalar(const uint8_t *raw, uint8_t *conv) {
   uint16_t i = 0;
   uint16_t j = 0;
   uint16_t counter = 0;
@@ -64,32 +44,160 @@ void ao40short_deinterleave(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t conv[AO40SH
   }
 }
 
+void ao40short_deinterleave(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t conv[AO40SHORT_CONV_SIZE]) {
+  ao40short_active_kernels()->deinterleave(raw, conv);
+}
+
+static void ao40short_decoder_defaults(struct ao40short_decoder *d) {
+  d->list_size = AO40SHORT_LIST_SIZE;
+  d->erasures = AO40SHORT_ERASURES;
+  d->erasure_threshold = AO40SHORT_ERASURE_THRESHOLD;
+}
+
+/* Decoder state lives in one block: the metrics and decisions of
+ * struct ao40short_v point into it, nothing is allocated per frame. */
+struct ao40short_decoder *ao40short_create_decoder(void) {
+  struct ao40short_decoder *d;
+
+#ifdef _WIN32
+  if ((d = _aligned_malloc(sizeof(*d), 16)) == AO40SHORT_NULL)
+    return AO40SHORT_NULL;
+#else
+  if (posix_memalign((void **)&d, 16, sizeof(*d)))
+    return AO40SHORT_NULL;
+#endif
+  d->vp.decisions = (ao40short_decision_t *)d->decisions;
+  ao40short_init_viterbi(&d->vp, 0);
+  ao40short_decoder_defaults(d);
+  return d;
+}
+
+void ao40short_delete_decoder(struct ao40short_decoder *d) {
+#ifdef _WIN32
+  _aligned_free(d);
+#else
+  free(d);
+#endif
+}
+
 /* Viterbi decoder:
- *   It uses the one generated from http://www.spiral.net/
+ *   The scalar butterfly engine ao40short_vit_step() or the SIMD kernels
+ *   picked by ao40short_dispatch.
+ *   The kernels read the uint8_t soft symbols directly, branchtab tells
+ *   how they are coded (ao40short_Branchtab or ao40short_Branchtab_s8).
+ *   fast: use the 8-bit metric kernel (if the kernel set has one)
  */
-void ao40short_viterbi(uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]) {
-  struct ao40short_v *vp;
-  AO40SHORT_COMPUTETYPE conv_compute[AO40SHORT_CONV_SIZE];
-  int i;
-
-  if((vp = ao40short_create_viterbi(AO40SHORT_FRAMEBITS)) == AO40SHORT_NULL){
-    printf("ao40short_create_viterbi failed\n");
-    exit(1);
-  }
+static void ao40short_viterbi_syms(struct ao40short_decoder *d, const uint8_t syms[AO40SHORT_CONV_SIZE], const AO40SHORT_COMPUTETYPE *branchtab, uint8_t dec_data[AO40SHORT_RS_SIZE], int fast) {
+  struct ao40short_v *vp = &d->vp;
 
+  vp->decisions = (ao40short_decision_t *)d->decisions;
   ao40short_init_viterbi(vp, 0);
+  vp->branchtab = branchtab;
+
+  if (fast)
+    ao40short_update_viterbi_blk_8(vp, syms, AO40SHORT_FRAMEBITS+(AO40SHORT_K-1));
+  else
+    ao40short_update_viterbi_blk(vp, syms, AO40SHORT_FRAMEBITS+(AO40SHORT_K-1));
+  ao40short_chainback_viterbi(vp, dec_data, AO40SHORT_FRAMEBITS, 0);
+}
+
+static void ao40short_viterbi_metrics(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE], int fast) {
+  ao40short_viterbi_syms(d, conv, ao40short_Branchtab, dec_data, fast);
+}
+
+void ao40short_viterbi_r(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]) {
+#ifdef AO40SHORT_VITERBI_8BIT
+  ao40short_viterbi_metrics(d, conv, dec_data, 1);
+#else
+  ao40short_viterbi_metrics(d, conv, dec_data, 0);
+#endif
+}
+
+/* Same as ao40short_viterbi_r for bipolar soft symbols: -128 is a sure 0 bit,
+ * 127 a sure 1 bit (the uint8_t symbol minus 128) */
+void ao40short_viterbi_s8_r(struct ao40short_decoder *d, const int8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]) {
+#ifdef AO40SHORT_VITERBI_8BIT
+  ao40short_viterbi_syms(d, (const uint8_t *)conv, ao40short_Branchtab_s8, dec_data, 1);
+#else
+  ao40short_viterbi_syms(d, (const uint8_t *)conv, ao40short_Branchtab_s8, dec_data, 0);
+#endif
+}
+
+/* Soft output Viterbi decoder:
+ *   Same dec_data as ao40short_viterbi_r with exact metrics, plus the
+ *   reliability of every byte of it: the smallest path metric difference
+ *   that would flip one of its bits (see ao40short_vit_sova.h). Low values mark
+ *   the bytes most likely in error.
+ */
+static void ao40short_byte_rel(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint16_t rel[AO40SHORT_RS_SIZE]) {
+  uint16_t bit_rel[AO40SHORT_FRAMEBITS];
+  int i, j;
 
-  // AO40SHORT_COMPUTETYPE is set to uint32, so convert uint8 to uint32
-  // but the softbit value should be between 0 and 255 (!)
-  i = AO40SHORT_CONV_SIZE;
-  while (i--) {
-    conv_compute[i] = conv[i];
+  ao40short_sova(&d->vp, conv, bit_rel);
+  for (i = 0; i < AO40SHORT_RS_SIZE; ++i) {
+    rel[i] = bit_rel[8*i];
+    for (j = 1; j < 8; ++j) {
+      if (rel[i] > bit_rel[8*i+j])
+        rel[i] = bit_rel[8*i+j];
+    }
   }
+}
 
-  ao40short_update_viterbi_blk(vp, conv_compute, AO40SHORT_FRAMEBITS+(AO40SHORT_K-1));
-  ao40short_chainback_viterbi(vp, dec_data, AO40SHORT_FRAMEBITS, 0);
+void ao40short_viterbi_soft_r(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE], uint16_t rel[AO40SHORT_RS_SIZE]) {
+  ao40short_viterbi_metrics(d, conv, dec_data, 0);
+  ao40short_byte_rel(d, conv, rel);
+}
+
+/* The functions without _r take their decoder from the heap: it is too
+ * big for small thread stacks */
+int ao40short_viterbi(uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]) {
+  struct ao40short_decoder *d;
+
+  if ((d = ao40short_create_decoder()) == AO40SHORT_NULL)
+    return -1;
+  ao40short_viterbi_r(d, conv, dec_data);
+  ao40short_delete_decoder(d);
+  return 0;
+}
+
+/* Frame-parallel Viterbi decoder:
+ *   Decodes n frames with one frame per vector lane if the kernel set has
+ *   a batch kernel, one by one otherwise. The batch kernels use exact
+ *   16-bit metrics, dec_data[i] is the same as ao40short_viterbi() without
+ *   AO40SHORT_VITERBI_8BIT would give for conv[i].
+ *   dec: decision buffer of AO40SHORT_FRAMEBITS+(AO40SHORT_K-1) rows
+ *   d: decoder for the frames that go one by one
+ */
+static void ao40short_viterbi_batch_dec(struct ao40short_decoder *d, uint8_t *const conv[], uint8_t *const dec_data[], int n, uint32_t (*dec)[AO40SHORT_NUMSTATES]) {
+  int lanes;
+
+  while (n > 1 && ao40short_active_kernels()->viterbi_batch != AO40SHORT_NULL) {
+    lanes = ao40short_active_kernels()->viterbi_batch((const uint8_t *const *)conv, n, dec);
+    ao40short_chainback_batch((const uint32_t (*)[AO40SHORT_NUMSTATES])dec, lanes, dec_data);
+    conv += lanes;
+    dec_data += lanes;
+    n -= lanes;
+  }
+  // a single frame left over is cheaper with the single-frame kernel
+  while (n-- > 0)
+    ao40short_viterbi_metrics(d, *conv++, *dec_data++, 0);
+}
+
+/* Returns 0, or -1 if the decision buffer can not be allocated */
+int ao40short_viterbi_batch(uint8_t *const conv[], uint8_t *const dec_data[], int n) {
+  uint32_t (*dec)[AO40SHORT_NUMSTATES];
+  struct ao40short_decoder *d;
 
-  ao40short_delete_viterbi(vp);
+  if ((dec = malloc(sizeof(*dec) * (AO40SHORT_FRAMEBITS+(AO40SHORT_K-1)))) == AO40SHORT_NULL)
+    return -1;
+  if ((d = ao40short_create_decoder()) == AO40SHORT_NULL) {
+    free(dec);
+    return -1;
+  }
+  ao40short_viterbi_batch_dec(d, conv, dec_data, n, dec);
+  ao40short_delete_decoder(d);
+  free(dec);
+  return 0;
 }
 
 void ao40short_descramble(uint8_t dec_data[AO40SHORT_RS_SIZE], uint8_t rs[AO40SHORT_RS_BLOCK_SIZE]) {
@@ -111,15 +219,130 @@ void ao40short_rs_decode(uint8_t rs[AO40SHORT_RS_BLOCK_SIZE], uint8_t data[AO40S
   }
 }
 
-void ao40short_decode_data(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
-  uint8_t conv[AO40SHORT_CONV_SIZE];
-  uint8_t dec_data[AO40SHORT_RS_SIZE];
-  uint8_t rs[AO40SHORT_RS_BLOCK_SIZE];
+/* Erasure decoding: when RS fails, erase the least reliable bytes (SOVA
+ * reliability below d->erasure_threshold, at most d->erasures of them)
+ * and decode again. A block with e errors and f erasures decodes if
+ * 2e + f <= AO40SHORT_NROOTS, so erasing the right bytes doubles what RS can
+ * fix. Tries AO40SHORT_ERASURE_STEP, 2*AO40SHORT_ERASURE_STEP, ... erasures, the
+ * fewest that decode win. d must still hold the exact decisions of conv,
+ * rs and error the result of the best path.
+ */
+static void ao40short_erasure_decode(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE],
+                                     uint8_t rs[AO40SHORT_RS_BLOCK_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
+  uint16_t rel[AO40SHORT_RS_SIZE];
+  uint8_t tmp[AO40SHORT_RS_BLOCK_SIZE];
+  int pos[AO40SHORT_RS_BLOCK_SIZE], eras_pos[AO40SHORT_NROOTS];
+  int i, j, k, n, m, max;
+  int8_t count;
 
+  // keep some parity for error detection: with AO40SHORT_NROOTS erasures
+  // every word decodes
+  max = (d->erasures < AO40SHORT_ERASURES_MAX) ? d->erasures : AO40SHORT_ERASURES_MAX;
+  ao40short_byte_rel(d, conv, rel);
+
+  // the max least reliable bytes under the threshold, least reliable first
+  n = 0;
+  for (i = 0; i < AO40SHORT_RS_BLOCK_SIZE; ++i) {
+    if (rel[i] >= d->erasure_threshold)
+      continue;
+    if (n == max && rel[i] >= rel[pos[n-1]])
+      continue;
+    j = (n < max) ? n++ : n-1;
+    for (; j > 0 && rel[pos[j-1]] > rel[i]; --j)
+      pos[j] = pos[j-1];
+    pos[j] = i;
+  }
+
+  for (k = AO40SHORT_ERASURE_STEP; k < n + AO40SHORT_ERASURE_STEP; k += AO40SHORT_ERASURE_STEP) {
+    m = (k < n) ? k : n;
+    for (j = 0; j < m; ++j)
+      eras_pos[j] = pos[j] + AO40SHORT_PAD;
+    memcpy(tmp, rs, AO40SHORT_RS_BLOCK_SIZE);
+    if ((count = ao40short_decode_rs_8(tmp, eras_pos, m)) >= 0) {
+      memcpy(rs, tmp, AO40SHORT_RS_BLOCK_SIZE);
+      memcpy(data, tmp, AO40SHORT_DATA_SIZE);
+      *error = count;
+      return;
+    }
+  }
+}
+
+/* List Viterbi: when RS fails on the best path, try the paths that leave
+ * it once (ao40short_vit_list.h) in order of path metric and keep the first one whose RS block decodes.
+ * d must still hold the exact decisions of conv, dec_data, rs and error
+ * the result of the best path.
+ */
+static void ao40short_list_decode(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE],
+                                  uint8_t rs[AO40SHORT_RS_BLOCK_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
+  struct ao40short_list l;
+  uint8_t cand[AO40SHORT_RS_SIZE];
+  uint8_t cand_rs[AO40SHORT_RS_BLOCK_SIZE];
+  int8_t cand_error;
+  int k, n;
+
+  n = ao40short_list_init(&l, &d->vp, conv, d->list_size - 1);
+  for (k = 0; k < n; ++k) {
+    ao40short_list_chainback(&l, &d->vp, k, cand);
+    if (memcmp(cand, dec_data, AO40SHORT_RS_SIZE) == 0)
+      continue;
+    ao40short_descramble(cand, cand_rs);
+    if ((cand_error = ao40short_decode_rs_8(cand_rs, AO40SHORT_NULL, 0)) < 0)
+      continue;
+
+    memcpy(dec_data, cand, AO40SHORT_RS_SIZE);
+    memcpy(rs, cand_rs, AO40SHORT_RS_BLOCK_SIZE);
+    memcpy(data, cand_rs, AO40SHORT_DATA_SIZE);
+    *error = cand_error;
+    return;
+  }
+}
+
+/* Second chances for a frame RS failed on, cheapest first. d must still
+ * hold the exact decisions of conv. */
+static void ao40short_rescue_frame(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE],
+                                   uint8_t rs[AO40SHORT_RS_BLOCK_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
+  if (d->erasures > 0)
+    ao40short_erasure_decode(d, conv, rs, data, error);
+  if (*error < 0 && d->list_size > 1)
+    ao40short_list_decode(d, conv, dec_data, rs, data, error);
+}
+
+static void ao40short_decode_frame(struct ao40short_decoder *d, uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error,
+                                   uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE], uint8_t rs[AO40SHORT_RS_BLOCK_SIZE]) {
   ao40short_deinterleave(raw, conv);
-  ao40short_viterbi(conv, dec_data);
+  ao40short_viterbi_r(d, conv, dec_data);
   ao40short_descramble(dec_data, rs);
   ao40short_rs_decode(rs, data, error);
+  if (*error >= 0)
+    return;
+#ifdef AO40SHORT_VITERBI_8BIT
+  // 8-bit metrics can lose marginal frames, retry with the exact kernel
+  ao40short_viterbi_metrics(d, conv, dec_data, 0);
+  ao40short_descramble(dec_data, rs);
+  ao40short_rs_decode(rs, data, error);
+  if (*error >= 0)
+    return;
+#endif
+  ao40short_rescue_frame(d, conv, dec_data, rs, data, error);
+}
+
+void ao40short_decode_data_r(struct ao40short_decoder *d, uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
+  uint8_t conv[AO40SHORT_CONV_SIZE];
+  uint8_t dec_data[AO40SHORT_RS_SIZE];
+  uint8_t rs[AO40SHORT_RS_BLOCK_SIZE];
+
+  ao40short_decode_frame(d, raw, data, error, conv, dec_data, rs);
+}
+
+void ao40short_decode_data(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error) {
+  struct ao40short_decoder *d;
+
+  if ((d = ao40short_create_decoder()) == AO40SHORT_NULL) {
+    *error = -1;
+    return;
+  }
+  ao40short_decode_data_r(d, raw, data, error);
+  ao40short_delete_decoder(d);
 }
 
 void ao40short_decode_data_debug(
@@ -130,8 +353,68 @@ void ao40short_decode_data_debug(
     uint8_t dec_data[AO40SHORT_RS_SIZE],    // Viterbi decoder output
     uint8_t rs[AO40SHORT_RS_BLOCK_SIZE]     // RS codeblocks without the leading padding 95 zeros
   ) {
-  ao40short_deinterleave(raw, conv);
-  ao40short_viterbi(conv, dec_data);
-  ao40short_descramble(dec_data, rs);
-  ao40short_rs_decode(rs, data, error);
+  struct ao40short_decoder *d;
+
+  if ((d = ao40short_create_decoder()) == AO40SHORT_NULL) {
+    *error = -1;
+    return;
+  }
+  ao40short_decode_frame(d, raw, data, error, conv, dec_data, rs);
+  ao40short_delete_decoder(d);
+}
+
+/* Decodes n frames with the frame-parallel Viterbi decoder, AO40SHORT_VITERBI_BATCH at a time.
+ * error[i] is set as by ao40short_decode_data(). Returns 0, or -1 if out of memory.
+ */
+int ao40short_decode_data_batch(uint8_t *const raw[], uint8_t *const data[], int8_t error[], int n) {
+  struct {
+    uint32_t dec[AO40SHORT_FRAMEBITS+(AO40SHORT_K-1)][AO40SHORT_NUMSTATES];
+    uint8_t conv[AO40SHORT_VITERBI_BATCH][AO40SHORT_CONV_SIZE];
+    uint8_t dec_data[AO40SHORT_VITERBI_BATCH][AO40SHORT_RS_SIZE];
+    uint8_t rs[AO40SHORT_VITERBI_BATCH][AO40SHORT_RS_BLOCK_SIZE];
+  } *buf;
+  uint8_t *conv[AO40SHORT_VITERBI_BATCH];
+  uint8_t *dec_data[AO40SHORT_VITERBI_BATCH];
+  uint8_t *block[AO40SHORT_VITERBI_BATCH];
+  struct ao40short_decoder *d;
+  int i, m;
+
+  if ((buf = malloc(sizeof(*buf))) == AO40SHORT_NULL)
+    return -1;
+  if ((d = ao40short_create_decoder()) == AO40SHORT_NULL) {
+    free(buf);
+    return -1;
+  }
+  for (i = 0; i < AO40SHORT_VITERBI_BATCH; ++i) {
+    conv[i] = buf->conv[i];
+    dec_data[i] = buf->dec_data[i];
+    block[i] = buf->rs[i];
+  }
+
+  while (n > 0) {
+    m = (n < AO40SHORT_VITERBI_BATCH) ? n : AO40SHORT_VITERBI_BATCH;
+    for (i = 0; i < m; ++i)
+      ao40short_deinterleave(raw[i], conv[i]);
+    ao40short_viterbi_batch_dec(d, conv, dec_data, m, buf->dec);
+    // the RS blocks of the whole round at once
+    for (i = 0; i < m; ++i)
+      ao40short_descramble(dec_data[i], buf->rs[i]);
+    ao40short_decode_rs_batch(block, error, m);
+    for (i = 0; i < m; ++i) {
+      memcpy(data[i], buf->rs[i], AO40SHORT_DATA_SIZE);
+      if (error[i] < 0 && (d->erasures > 0 || d->list_size > 1)) {
+        // erasures and the list need the decisions of this frame alone
+        ao40short_viterbi_metrics(d, conv[i], dec_data[i], 0);
+        ao40short_rescue_frame(d, conv[i], dec_data[i], buf->rs[i], data[i], &error[i]);
+      }
+    }
+    raw += m;
+    data += m;
+    error += m;
+    n -= m;
+  }
+
+  ao40short_delete_decoder(d);
+  free(buf);
+  return 0;
 }
@@ -3,14 +3,31 @@
 
 #include <stdint.h>
 #include "ao40short_spiral-vit_scalar_1280.h"
+#include "ao40short_dispatch.h"
 #include "ao40short_decode_rs.h"
+#include "ao40short_vit_list.h"
+#include "ao40short_vit_sova.h"
 
 #define AO40SHORT_DEBUG
+//#define AO40SHORT_VITERBI_8BIT  // 8-bit SIMD metrics, frames failing RS are re-run with exact 16-bit metrics
+#ifndef AO40SHORT_LIST_SIZE
+#define AO40SHORT_LIST_SIZE 1     // paths tried by the list Viterbi when RS fails on the best one, 1: off
+#endif
+#ifndef AO40SHORT_ERASURES
+#define AO40SHORT_ERASURES 0      // least reliable bytes erased when RS fails, 0: off
+#endif
+#ifndef AO40SHORT_ERASURE_THRESHOLD
+#define AO40SHORT_ERASURE_THRESHOLD 128  // SOVA reliability a byte must be below to be erased (255: one symbol flipped)
+#endif
+#define AO40SHORT_ERASURE_STEP 4  // erasures added per RS retry
+#define AO40SHORT_ERASURES_MAX (AO40SHORT_NROOTS-8)
 
 #define AO40SHORT_INTERLEAVER_STEP_SIZE    51
 #define AO40SHORT_INTERLEAVER_PILOT_BITS   80
 
 #define AO40SHORT_RAW_SIZE      2652 // 51*52
+#define AO40SHORT_RAW_ROWS        52 // interleaver matrix: written by rows,
+#define AO40SHORT_RAW_COLS        51 // read by columns
 #define AO40SHORT_CONV_SIZE     2572
 
 #define AO40SHORT_RS_SIZE        160
@@ -18,6 +35,8 @@
 #define AO40SHORT_FRAME_BITS    1280
 #define AO40SHORT_RS_BLOCK_SIZE  160
 
+#define AO40SHORT_VITERBI_BATCH   32  // frames per ao40short_decode_data_batch() round, the widest batch kernel
+
 #if !defined(AO40SHORT_NULL)
 #define AO40SHORT_NULL ((void *)0)
 #endif
@@ -26,9 +45,37 @@
 extern "C" {
 #endif // __cplusplus
 
-extern const uint8_t ao40short_Scrambler[320];
+/* Decoder state: create it once and reuse it for any number of frames
+ * through the _r functions. A decoder serves one thread at a time,
+ * separate decoders can decode in parallel. A struct ao40short_decoder is
+ * about 11 KB: the _r functions leave it to the caller where it lives, on
+ * the stack only if that has room. The functions without _r allocate and
+ * free one on the heap per call, a malloc() and free() of that size for
+ * every frame; decoding a stream, create one decoder and use the _r
+ * functions. If that allocation fails, ao40short_viterbi() returns -1 and
+ * the ao40short_decode_data() functions report error -1.
+ */
+struct ao40short_decoder {
+  struct ao40short_v vp;
+  // ao40short_decision_t rows, its alignment does not allow a plain array
+  __attribute__ ((aligned (16))) uint32_t decisions[(AO40SHORT_FRAMEBITS+(AO40SHORT_K-1))*AO40SHORT_NUMSTATES/32];
+  int list_size;  // paths tried when RS fails, AO40SHORT_LIST_SIZE by default
+  int erasures;   // bytes erased when RS fails, AO40SHORT_ERASURES by default
+  uint16_t erasure_threshold;  // AO40SHORT_ERASURE_THRESHOLD by default
+};
+
+struct ao40short_decoder *ao40short_create_decoder(void);  // NULL if out of memory
+void ao40short_delete_decoder(struct ao40short_decoder *d);
 
+void ao40short_deinterleave(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t conv[AO40SHORT_CONV_SIZE]);
+int ao40short_viterbi(uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]);
+void ao40short_viterbi_r(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]);
+void ao40short_viterbi_s8_r(struct ao40short_decoder *d, const int8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE]);
+void ao40short_viterbi_soft_r(struct ao40short_decoder *d, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE], uint16_t rel[AO40SHORT_RS_SIZE]);
+int ao40short_viterbi_batch(uint8_t *const conv[], uint8_t *const dec_data[], int n);
 void ao40short_decode_data(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error);
+void ao40short_decode_data_r(struct ao40short_decoder *d, uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error);
+int ao40short_decode_data_batch(uint8_t *const raw[], uint8_t *const data[], int8_t error[], int n);
 
 #ifdef AO40SHORT_DEBUG
 void ao40short_decode_data_debug(uint8_t raw[AO40SHORT_RAW_SIZE], uint8_t data[AO40SHORT_DATA_SIZE], int8_t *error, uint8_t conv[AO40SHORT_CONV_SIZE], uint8_t dec_data[AO40SHORT_RS_SIZE], uint8_t rs[AO40SHORT_RS_BLOCK_SIZE]);
@@ -3,28 +3,29 @@
 
 #include <stdint.h> // because of uint8_t
 
-#define AO40SHORT_NN     255  // GF(2^8-1)
-#define AO40SHORT_NROOTS  32
-#define AO40SHORT_FCR    112
-#define AO40SHORT_PRIM    11
-#define AO40SHORT_IPRIM  116
-#define AO40SHORT_PAD     95
+#include "ao40short_gf.h"
 
-#include <stdio.h>
+#ifndef AO40SHORT_RS_FAST_T
+#define AO40SHORT_RS_FAST_T 2  // errors solved in closed form without erasures, 0: off
+#endif
 
-extern const uint8_t AO40SHORT_ALPHA_TO[];
-extern const uint8_t AO40SHORT_INDEX_OF[];
+void ao40short_rs_syndrome_scalar(const uint8_t *data, uint8_t s[AO40SHORT_NROOTS]);
+int ao40short_rs_chien_scalar(const uint8_t lambda[AO40SHORT_NROOTS+1], int deg_lambda, uint8_t root[AO40SHORT_NROOTS], uint8_t loc[AO40SHORT_NROOTS]);
 
-#define AO40SHORT_MODNN(x) ao40short_mod255(x)
+int8_t ao40short_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras);
 
-static inline int ao40short_mod255(int x){
-  while (x >= 255) {
-    x -= 255;
-    x = (x >> 8) + (x & 255);
-  }
-  return x;
-}
+/* As ao40short_decode_rs_8(), and tells in *path which way the word went */
+#define AO40SHORT_RS_PATH_CLEAN 0  // zero syndromes
+#define AO40SHORT_RS_PATH_SMALL 1  // one or two errors, solved in closed form
+#define AO40SHORT_RS_PATH_BM    2  // Berlekamp-Massey, Chien search and Forney
+int8_t ao40short_decode_rs_8_path(uint8_t *data, int *eras_pos, int no_eras, int *path);
 
-int8_t ao40short_decode_rs_8(uint8_t *data, int *eras_pots, int no_eras);
+/* Decodes the n words data[k] in place, error[k] as ao40short_decode_rs_8()
+ * without erasures returns. In groups of AO40SHORT_RS_BATCH_MIN or more words
+ * the syndromes are formed across words, one per vector lane, and words
+ * with zero syndromes are done right there. */
+#define AO40SHORT_RS_BATCH     64  // words per syndrome round, the widest batch kernel
+#define AO40SHORT_RS_BATCH_MIN 16  // fewer go one at a time
+void ao40short_decode_rs_batch(uint8_t *const data[], int8_t error[], int n);
 
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef AO40SHORT_DISPATCH_H
+#define AO40SHORT_DISPATCH_H
+
+#include <stdint.h>
+#include "ao40short_cpu.h"
+#include "ao40short_spiral-vit_scalar_1280.h"
+#include "ao40short_vit_simd.h"
+#include "ao40short_decode_rs.h"
+
+/*
+ * Runtime kernel selection
+ *
+ * One kernel set per CPU feature level of ao40short_cpu.h, the active one
+ * that of ao40short_get_kernel(): the best for the running CPU unless pinned
+ * with the AO40SHORT_KERNEL environment variable or ao40short_set_kernel().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct ao40short_kernels {
+  void (*update_viterbi)(struct ao40short_v *vp, const uint8_t *syms, int nbits);
+  void (*update_viterbi_8)(struct ao40short_v *vp, const uint8_t *syms, int nbits);
+  int  (*viterbi_batch)(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40SHORT_NUMSTATES]); // NULL: no frame-parallel kernel
+  void (*deinterleave)(const uint8_t *raw, uint8_t *conv);
+  void (*rs_syndrome)(const uint8_t *data, uint8_t s[AO40SHORT_NROOTS]);
+  int  (*rs_syndrome_batch)(const uint8_t *const data[], int n, uint8_t (*s)[AO40SHORT_NROOTS]); // NULL: no word-parallel kernel
+  int  (*rs_chien)(const uint8_t lambda[AO40SHORT_NROOTS+1], int deg_lambda, uint8_t root[AO40SHORT_NROOTS], uint8_t loc[AO40SHORT_NROOTS]);
+};
+
+extern const struct ao40short_kernels ao40short_kernel_table[AO40SHORT_KERNEL_COUNT];
+
+/* Active kernel set, never NULL */
+static inline const struct ao40short_kernels *ao40short_active_kernels(void) {
+  return &ao40short_kernel_table[ao40short_get_kernel()];
+}
+
+/* Deinterleaver implementations, see ao40short_deinterleave() */
+void ao40short_deinterleave_scalar(const uint8_t *raw, uint8_t *conv);
+#ifdef AO40SHORT_X86_KERNELS
+void ao40short_deinterleave_sse2(const uint8_t *raw, uint8_t *conv);
+void ao40short_deinterleave_avx2(const uint8_t *raw, uint8_t *conv);
+#endif
+
+/* RS syndrome and Chien search implementations, see ao40short_rs_simd.c */
+#ifdef AO40SHORT_X86_KERNELS
+void ao40short_rs_syndrome_ssse3(const uint8_t *data, uint8_t s[AO40SHORT_NROOTS]);
+void ao40short_rs_syndrome_avx2(const uint8_t *data, uint8_t s[AO40SHORT_NROOTS]);
+void ao40short_rs_syndrome_avx512bw(const uint8_t *data, uint8_t s[AO40SHORT_NROOTS]);
+int ao40short_rs_syndrome_batch_ssse3(const uint8_t *const data[], int n, uint8_t (*s)[AO40SHORT_NROOTS]);
+int ao40short_rs_syndrome_batch_avx2(const uint8_t *const data[], int n, uint8_t (*s)[AO40SHORT_NROOTS]);
+int ao40short_rs_syndrome_batch_avx512bw(const uint8_t *const data[], int n, uint8_t (*s)[AO40SHORT_NROOTS]);
+int ao40short_rs_chien_ssse3(const uint8_t lambda[AO40SHORT_NROOTS+1], int deg_lambda, uint8_t root[AO40SHORT_NROOTS], uint8_t loc[AO40SHORT_NROOTS]);
+int ao40short_rs_chien_avx2(const uint8_t lambda[AO40SHORT_NROOTS+1], int deg_lambda, uint8_t root[AO40SHORT_NROOTS], uint8_t loc[AO40SHORT_NROOTS]);
+#endif
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40SHORT_DISPATCH_H */
@@ -0,0 +1,212 @@
+/*
+ * Frame-parallel Viterbi kernels
+ *
+ * Every AO-40 short frame runs the same 1286 trellis steps from and to state 0,
+ * so a batch of frames is decoded with one frame per vector lane: the
+ * butterflies need no shuffles, only the symbols are gathered per step.
+ * Metrics are wrapping 16-bit values compared through their difference,
+ * so each lane takes exactly the decisions of the single-frame kernels.
+ *
+ * dec[step][state] holds the decision of every lane as a bit mask.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40short_vit_simd.h"
+
+#define AO40SHORT_BATCH_STEPS (AO40SHORT_FRAMEBITS+(AO40SHORT_K-1))
+
+/* Branch of butterfly i: bit 1 set if the first encoder output is
+ * inverted, bit 0 for the second one (same rule as ao40short_Branchtab) */
+static void ao40short_batch_branches(uint8_t idx[AO40SHORT_NUMSTATES/2]) {
+  int polys[AO40SHORT_RATE] = AO40SHORT_POLYS;
+  int state;
+
+  for (state = 0; state < AO40SHORT_NUMSTATES/2; ++state) {
+    idx[state] = (uint8_t)((((polys[0] < 0) ^ ao40short_parity((2*state) & abs(polys[0]))) << 1)
+                         | ((polys[1] < 0) ^ ao40short_parity((2*state) & abs(polys[1]))));
+  }
+}
+
+/* Chainback of the first lanes frames, same walk as ao40short_chainback_viterbi().
+ * All lanes go back together, so every decision row is read only once */
+void ao40short_chainback_batch(const uint32_t (*dec)[AO40SHORT_NUMSTATES], int lanes, uint8_t *const data[]) {
+  const uint32_t (*d)[AO40SHORT_NUMSTATES] = dec + (AO40SHORT_K-1);
+  uint32_t endstate[32] = {0};
+  uint32_t nbits = AO40SHORT_FRAMEBITS;
+  uint32_t k;
+  int l;
+
+  while (nbits-- != 0) {
+    for (l = 0; l < lanes; ++l) {
+      k = (d[nbits][endstate[l] >> (8-(AO40SHORT_K-1))] >> l) & 1;
+      endstate[l] = (endstate[l] >> 1) | (k << (AO40SHORT_K-2+(8-(AO40SHORT_K-1))));
+      data[l][nbits>>3] = (uint8_t)endstate[l];
+    }
+  }
+}
+
+#ifdef AO40SHORT_X86_KERNELS
+#include <immintrin.h>
+
+/* Symbols of step s for every lane, unused lanes are zero */
+static inline void ao40short_batch_symbols(const uint8_t *const conv[], int lanes, int s,
+                                      uint16_t sym0[], uint16_t sym1[]) {
+  int l;
+
+  for (l = 0; l < lanes; ++l) {
+    sym0[l] = conv[l][2*s];
+    sym1[l] = conv[l][2*s+1];
+  }
+}
+
+AO40SHORT_TARGET("sse2")
+int ao40short_viterbi_batch_sse2(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40SHORT_NUMSTATES]) {
+  __m128i a[AO40SHORT_NUMSTATES], b[AO40SHORT_NUMSTATES], *old_m = a, *new_m = b, *tmp_m, T[4];
+  uint16_t sym0[8] __attribute__ ((aligned (16))) = {0};
+  uint16_t sym1[8] __attribute__ ((aligned (16))) = {0};
+  uint8_t idx[AO40SHORT_NUMSTATES/2];
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i inv = _mm_set1_epi16(255);
+  int lanes = (n < 8) ? n : 8;
+  int i, s;
+
+  ao40short_batch_branches(idx);
+  old_m[0] = zero;
+  for (i = 1; i < AO40SHORT_NUMSTATES; ++i)
+    old_m[i] = _mm_set1_epi16(63);
+
+  for (s = 0; s < AO40SHORT_BATCH_STEPS; ++s) {
+    __m128i s0, s1;
+
+    ao40short_batch_symbols(conv, lanes, s, sym0, sym1);
+    s0 = _mm_load_si128((const __m128i *)sym0);
+    s1 = _mm_load_si128((const __m128i *)sym1);
+    T[0] = _mm_add_epi16(s0, s1);
+    T[1] = _mm_add_epi16(s0, _mm_xor_si128(s1, inv));
+    T[2] = _mm_add_epi16(_mm_xor_si128(s0, inv), s1);
+    T[3] = _mm_add_epi16(_mm_xor_si128(s0, inv), _mm_xor_si128(s1, inv));
+
+    for (i = 0; i < AO40SHORT_NUMSTATES/2; ++i) {
+      __m128i t  = T[idx[i]];
+      __m128i tc = T[3 - idx[i]];
+      __m128i m0 = _mm_add_epi16(old_m[i], t);
+      __m128i m1 = _mm_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], tc);
+      __m128i m2 = _mm_add_epi16(old_m[i], tc);
+      __m128i m3 = _mm_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], t);
+      __m128i d0 = _mm_cmpgt_epi16(_mm_sub_epi16(m0, m1), zero);
+      __m128i d1 = _mm_cmpgt_epi16(_mm_sub_epi16(m2, m3), zero);
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(d0, d1));
+
+      new_m[2*i]   = _mm_or_si128(_mm_and_si128(d0, m1), _mm_andnot_si128(d0, m0));
+      new_m[2*i+1] = _mm_or_si128(_mm_and_si128(d1, m3), _mm_andnot_si128(d1, m2));
+      dec[s][2*i]   = mask & 0xff;
+      dec[s][2*i+1] = mask >> 8;
+    }
+    tmp_m = old_m;
+    old_m = new_m;
+    new_m = tmp_m;
+  }
+  return lanes;
+}
+
+AO40SHORT_TARGET("avx2")
+int ao40short_viterbi_batch_avx2(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40SHORT_NUMSTATES]) {
+  __m256i a[AO40SHORT_NUMSTATES], b[AO40SHORT_NUMSTATES], *old_m = a, *new_m = b, *tmp_m, T[4];
+  uint16_t sym0[16] __attribute__ ((aligned (32))) = {0};
+  uint16_t sym1[16] __attribute__ ((aligned (32))) = {0};
+  uint8_t idx[AO40SHORT_NUMSTATES/2];
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i inv = _mm256_set1_epi16(255);
+  int lanes = (n < 16) ? n : 16;
+  int i, s;
+
+  ao40short_batch_branches(idx);
+  old_m[0] = zero;
+  for (i = 1; i < AO40SHORT_NUMSTATES; ++i)
+    old_m[i] = _mm256_set1_epi16(63);
+
+  for (s = 0; s < AO40SHORT_BATCH_STEPS; ++s) {
+    __m256i s0, s1;
+
+    ao40short_batch_symbols(conv, lanes, s, sym0, sym1);
+    s0 = _mm256_load_si256((const __m256i *)sym0);
+    s1 = _mm256_load_si256((const __m256i *)sym1);
+    T[0] = _mm256_add_epi16(s0, s1);
+    T[1] = _mm256_add_epi16(s0, _mm256_xor_si256(s1, inv));
+    T[2] = _mm256_add_epi16(_mm256_xor_si256(s0, inv), s1);
+    T[3] = _mm256_add_epi16(_mm256_xor_si256(s0, inv), _mm256_xor_si256(s1, inv));
+
+    for (i = 0; i < AO40SHORT_NUMSTATES/2; ++i) {
+      __m256i t  = T[idx[i]];
+      __m256i tc = T[3 - idx[i]];
+      __m256i m0 = _mm256_add_epi16(old_m[i], t);
+      __m256i m1 = _mm256_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], tc);
+      __m256i m2 = _mm256_add_epi16(old_m[i], tc);
+      __m256i m3 = _mm256_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], t);
+      __m256i d0 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m0, m1), zero);
+      __m256i d1 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m2, m3), zero);
+      /* packs works per 128-bit lane: bytes are d0 0-7, d1 0-7, d0 8-15, d1 8-15 */
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_packs_epi16(d0, d1));
+
+      new_m[2*i]   = _mm256_blendv_epi8(m0, m1, d0);
+      new_m[2*i+1] = _mm256_blendv_epi8(m2, m3, d1);
+      dec[s][2*i]   = (mask & 0xff) | ((mask >> 8) & 0xff00);
+      dec[s][2*i+1] = ((mask >> 8) & 0xff) | ((mask >> 16) & 0xff00);
+    }
+    tmp_m = old_m;
+    old_m = new_m;
+    new_m = tmp_m;
+  }
+  return lanes;
+}
+
+AO40SHORT_TARGET("avx512bw")
+int ao40short_viterbi_batch_avx512bw(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40SHORT_NUMSTATES]) {
+  __m512i a[AO40SHORT_NUMSTATES], b[AO40SHORT_NUMSTATES], *old_m = a, *new_m = b, *tmp_m, T[4];
+  uint16_t sym0[32] __attribute__ ((aligned (64))) = {0};
+  uint16_t sym1[32] __attribute__ ((aligned (64))) = {0};
+  uint8_t idx[AO40SHORT_NUMSTATES/2];
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i inv = _mm512_set1_epi16(255);
+  int lanes = (n < 32) ? n : 32;
+  int i, s;
+
+  ao40short_batch_branches(idx);
+  old_m[0] = zero;
+  for (i = 1; i < AO40SHORT_NUMSTATES; ++i)
+    old_m[i] = _mm512_set1_epi16(63);
+
+  for (s = 0; s < AO40SHORT_BATCH_STEPS; ++s) {
+    __m512i s0, s1;
+
+    ao40short_batch_symbols(conv, lanes, s, sym0, sym1);
+    s0 = _mm512_load_si512((const void *)sym0);
+    s1 = _mm512_load_si512((const void *)sym1);
+    T[0] = _mm512_add_epi16(s0, s1);
+    T[1] = _mm512_add_epi16(s0, _mm512_xor_si512(s1, inv));
+    T[2] = _mm512_add_epi16(_mm512_xor_si512(s0, inv), s1);
+    T[3] = _mm512_add_epi16(_mm512_xor_si512(s0, inv), _mm512_xor_si512(s1, inv));
+
+    for (i = 0; i < AO40SHORT_NUMSTATES/2; ++i) {
+      __m512i t  = T[idx[i]];
+      __m512i tc = T[3 - idx[i]];
+      __m512i m0 = _mm512_add_epi16(old_m[i], t);
+      __m512i m1 = _mm512_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], tc);
+      __m512i m2 = _mm512_add_epi16(old_m[i], tc);
+      __m512i m3 = _mm512_add_epi16(old_m[i+AO40SHORT_NUMSTATES/2], t);
+      __mmask32 d0 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m0, m1), zero);
+      __mmask32 d1 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m2, m3), zero);
+
+      new_m[2*i]   = _mm512_mask_blend_epi16(d0, m0, m1);
+      new_m[2*i+1] = _mm512_mask_blend_epi16(d1, m2, m3);
+      dec[s][2*i]   = (uint32_t)d0;
+      dec[s][2*i+1] = (uint32_t)d1;
+    }
+    tmp_m = old_m;
+    old_m = new_m;
+    new_m = tmp_m;
+  }
+  return lanes;
+}
+#endif /* AO40SHORT_X86_KERNELS */
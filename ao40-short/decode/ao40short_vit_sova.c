@@ -0,0 +1,37 @@
+/*
+ * Soft output Viterbi: bit reliabilities of a decoded frame
+ */
+
+#include <stdint.h>
+#include "ao40short_vit_sova.h"
+
+void ao40short_sova(const struct ao40short_v *vp, const uint8_t *syms, uint16_t rel[AO40SHORT_FRAMEBITS]) {
+  uint8_t state[AO40SHORT_LIST_ROWS];
+  uint8_t best[AO40SHORT_LIST_ROWS];
+  uint32_t gap[AO40SHORT_LIST_ROWS];
+  uint32_t g, u;
+  int r, j, end, s, d;
+
+  ao40short_list_gaps(vp, syms, state, gap);
+  for (r = 0; r < AO40SHORT_LIST_ROWS; ++r)
+    best[r] = (uint8_t)ao40short_list_bit(vp, r, state[r]);
+  for (r = 0; r < AO40SHORT_FRAMEBITS; ++r)
+    rel[r] = AO40SHORT_SOVA_MAX;
+
+  // row r decides bit r-(K-1), the state on row r-1 is (state >> 1) | (d << K-2)
+  for (r = AO40SHORT_K-1; r < AO40SHORT_LIST_ROWS; ++r) {
+    g = gap[r];
+    if (g >= AO40SHORT_SOVA_MAX)
+      continue;
+    rel[r-(AO40SHORT_K-1)] = (uint16_t)g;
+    s = (state[r] >> 1) | ((best[r] ^ 1) << (AO40SHORT_K-2));
+    end = (r - AO40SHORT_SOVA_DEPTH > AO40SHORT_K-1) ? r - AO40SHORT_SOVA_DEPTH : AO40SHORT_K-1;
+    for (j = r-1; j >= end && s != state[j]; --j) {
+      d = (int)(((uint64_t)vp->decisions[j].w[1] << 32 | vp->decisions[j].w[0]) >> s) & 1;
+      // no branch on the bits: which ones differ is unpredictable
+      u = (d != best[j]) ? g : AO40SHORT_SOVA_MAX;
+      rel[j-(AO40SHORT_K-1)] = (rel[j-(AO40SHORT_K-1)] < u) ? rel[j-(AO40SHORT_K-1)] : (uint16_t)u;
+      s = (s >> 1) | (d << (AO40SHORT_K-2));
+    }
+  }
+}
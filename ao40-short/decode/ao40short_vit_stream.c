@@ -0,0 +1,124 @@
+/*
+ * Sliding-window Viterbi decoder for continuous streams
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40short_vit_stream.h"
+#include "ao40short_dispatch.h"
+
+#define AO40SHORT_STREAM_ADDSHIFT (8-(AO40SHORT_K-1))
+
+int ao40short_stream_init(struct ao40short_stream *s, int depth, int starting_state) {
+  int i;
+
+  if (depth < AO40SHORT_STREAM_MIN_DEPTH || depth > AO40SHORT_STREAM_MAX_DEPTH)
+    return -1;
+
+  ao40short_init_viterbi(&s->vp, starting_state);
+  if (starting_state < 0) {
+    for (i = 0; i < AO40SHORT_NUMSTATES; ++i)
+      s->vp.old_metrics->t[i] = 0;
+  }
+  s->steps = 0;
+  s->emitted = 0;
+  s->depth = depth;
+  s->npending = 0;
+  return 0;
+}
+
+static int ao40short_stream_best(const struct ao40short_stream *s) {
+  const AO40SHORT_COMPUTETYPE *X = s->vp.old_metrics->t;
+  int i, best = 0;
+
+  for (i = 1; i < AO40SHORT_NUMSTATES; ++i) {
+    if (X[i] < X[best])
+      best = i;
+  }
+  return best;
+}
+
+/* Walk back from the newest row to the one of the oldest held bit and
+ * write nbytes bytes starting there, same walk as ao40short_chainback_viterbi() */
+static void ao40short_stream_traceback(struct ao40short_stream *s, int state, int nbytes, uint8_t *out) {
+  uint32_t endstate = (uint32_t)state << AO40SHORT_STREAM_ADDSHIFT;
+  uint32_t last = s->emitted + (AO40SHORT_K-1);
+  uint32_t j = s->steps;
+  uint32_t bit, k;
+
+  while (j-- != last) {
+    const uint32_t *w = s->decisions[j & (AO40SHORT_STREAM_RING-1)];
+
+    k = (w[(endstate>>AO40SHORT_STREAM_ADDSHIFT)/32] >> ((endstate>>AO40SHORT_STREAM_ADDSHIFT)%32)) & 1;
+    endstate = (endstate >> 1) | (k << (AO40SHORT_K-2+AO40SHORT_STREAM_ADDSHIFT));
+    bit = j - last;
+    if ((bit & 7) == 0 && bit < 8*(uint32_t)nbytes)
+      out[bit >> 3] = (uint8_t)endstate;
+  }
+  s->emitted += 8*nbytes;
+}
+
+/* Run npairs trellis steps, emitting every byte as soon as it is due */
+static int ao40short_stream_steps(struct ao40short_stream *s, const uint8_t *syms, int npairs, uint8_t *out) {
+  uint32_t due, pos;
+  int n, nout = 0;
+
+  while (npairs > 0) {
+    // steps until the next byte has depth bits decoded after it
+    due = s->emitted + 8 + (AO40SHORT_K-1) + s->depth;
+    n = (int)(due - s->steps);
+    pos = s->steps & (AO40SHORT_STREAM_RING-1);
+    if (n > npairs)
+      n = npairs;
+    if (n > (int)(AO40SHORT_STREAM_RING - pos))
+      n = AO40SHORT_STREAM_RING - pos;
+
+    s->vp.decisions = (ao40short_decision_t *)s->decisions[pos];
+    ao40short_active_kernels()->update_viterbi(&s->vp, syms, n);
+    ao40short_renormalize(s->vp.old_metrics->t, AO40SHORT_STREAM_RENORM);
+    s->steps += n;
+    syms += 2*n;
+    npairs -= n;
+
+    if (s->steps == due) {
+      ao40short_stream_traceback(s, ao40short_stream_best(s), 1, out + nout);
+      nout++;
+    }
+  }
+  return nout;
+}
+
+int ao40short_stream_update(struct ao40short_stream *s, const uint8_t *syms, int nsyms, uint8_t *out) {
+  uint8_t pair[2];
+  int nout = 0;
+
+  if (nsyms <= 0)
+    return 0;
+  if (s->npending) {
+    pair[0] = s->pending;
+    pair[1] = *syms++;
+    --nsyms;
+    s->npending = 0;
+    nout += ao40short_stream_steps(s, pair, 1, out);
+  }
+
+  nout += ao40short_stream_steps(s, syms, nsyms/2, out + nout);
+
+  if (nsyms & 1) {
+    s->pending = syms[nsyms-1];
+    s->npending = 1;
+  }
+  return nout;
+}
+
+int ao40short_stream_flush(struct ao40short_stream *s, int endstate, uint8_t *out) {
+  int nbytes;
+
+  if (s->steps < s->emitted + (AO40SHORT_K-1) + 8)
+    return 0;
+  nbytes = (s->steps - s->emitted - (AO40SHORT_K-1)) / 8;
+  if (endstate < 0)
+    endstate = ao40short_stream_best(s);
+  ao40short_stream_traceback(s, endstate & (AO40SHORT_NUMSTATES-1), nbytes, out);
+  return nbytes;
+}
@@ -0,0 +1,57 @@
+#ifndef AO40SHORT_VIT_STREAM_H
+#define AO40SHORT_VIT_STREAM_H
+
+#include <stdint.h>
+#include "ao40short_spiral-vit_scalar_1280.h"
+
+/*
+ * Sliding-window Viterbi decoder for a continuous stream of the K=7 r=1/2
+ * (79, -109) code.
+ *
+ * - Decisions are kept in a ring of AO40SHORT_STREAM_RING rows, the memory use
+ *   is constant no matter how long the stream is.
+ * - A byte is traced back from the best state as soon as depth more bits
+ *   have been decoded after it, so every byte comes out with the same
+ *   latency and the output does not depend on how the input is split up.
+ * - Path metrics are renormalized by ao40short_renormalize() after every block,
+ *   the SIMD kernels keep them modulo 2^16 in between.
+ * - Symbols are uint8_t soft bits as for ao40short_viterbi(), two per bit.
+ */
+
+#define AO40SHORT_STREAM_RING       512  // decision rows, power of two
+#define AO40SHORT_STREAM_MIN_DEPTH  (AO40SHORT_K-1)
+#define AO40SHORT_STREAM_MAX_DEPTH  256  // traceback depth in bits
+#define AO40SHORT_STREAM_RENORM     (1 << 16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct ao40short_stream {
+  struct ao40short_v vp;
+  __attribute__ ((aligned (16))) uint32_t decisions[AO40SHORT_STREAM_RING][AO40SHORT_NUMSTATES/32];
+  uint32_t steps;    // trellis steps done
+  uint32_t emitted;  // decoded bits written out
+  int depth;         // traceback depth in bits
+  int npending;      // 1 if pending holds the first symbol of a pair
+  uint8_t pending;
+};
+
+/* starting_state: encoder state at the first symbol, -1 if unknown.
+ * Returns 0, or -1 if depth is out of range. */
+int ao40short_stream_init(struct ao40short_stream *s, int depth, int starting_state);
+
+/* Decodes nsyms >= 0 soft symbols, a negative nsyms decodes nothing.
+ * Returns the number of bytes written to out (at most nsyms/16 + 1). */
+int ao40short_stream_update(struct ao40short_stream *s, const uint8_t *syms, int nsyms, uint8_t *out);
+
+/* Traces back the bits still held from endstate (-1: the best state) and
+ * writes the whole bytes among them. Returns the number of bytes, at most
+ * (AO40SHORT_STREAM_MAX_DEPTH + 8) / 8. Call ao40short_stream_init() before reuse. */
+int ao40short_stream_flush(struct ao40short_stream *s, int endstate, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40SHORT_VIT_STREAM_H */
@@ -50,8 +50,6 @@ U :    0 |    4 |    0         |
 #define AO40SHORT_SCRAMBLER_POLY 0x95
 #define AO40SHORT_CPOLYA         0x4f // 79
 #define AO40SHORT_CPOLYB         0x6d // 109
-#define AO40SHORT_GF_POLY        0x187
-#define AO40SHORT_A0             255
 
 //#define AO40SHORT_ENABLE_BIT_OUTPUT  // enable debug bit output mode
 
@@ -61,59 +59,13 @@ U :    0 |    4 |    0         |
 
 #include <stdint.h>
 #include "ao40short_enc.h"
+#include "ao40short_gf.h"
 
-static const uint8_t RS_poly[] = {249,59,66,4,43,126,251,97,30,3,213,50,66,170,5,24};
-static uint8_t RS_block[32];
-static uint16_t bit_count;
-static uint8_t  Scrambler;
-static uint8_t  Conv_sr;
-static uint8_t *Interleaver;
-
-#define INDEX_OF(x) ( Index_of[ (x) ] )
-#define ALPHA_TO(x) ( Alpha_to[ (x) ] )
-static const uint8_t Alpha_to[] = {
-  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x87, 0x89, 0x95, 0xad, 0xdd, 0x3d, 0x7a, 0xf4,
-  0x6f, 0xde, 0x3b, 0x76, 0xec, 0x5f, 0xbe, 0xfb, 0x71, 0xe2, 0x43, 0x86, 0x8b, 0x91, 0xa5, 0xcd,
-  0x1d, 0x3a, 0x74, 0xe8, 0x57, 0xae, 0xdb, 0x31, 0x62, 0xc4, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0x67,
-  0xce, 0x1b, 0x36, 0x6c, 0xd8, 0x37, 0x6e, 0xdc, 0x3f, 0x7e, 0xfc, 0x7f, 0xfe, 0x7b, 0xf6, 0x6b,
-  0xd6, 0x2b, 0x56, 0xac, 0xdf, 0x39, 0x72, 0xe4, 0x4f, 0x9e, 0xbb, 0xf1, 0x65, 0xca, 0x13, 0x26,
-  0x4c, 0x98, 0xb7, 0xe9, 0x55, 0xaa, 0xd3, 0x21, 0x42, 0x84, 0x8f, 0x99, 0xb5, 0xed, 0x5d, 0xba,
-  0xf3, 0x61, 0xc2, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
-  0x47, 0x8e, 0x9b, 0xb1, 0xe5, 0x4d, 0x9a, 0xb3, 0xe1, 0x45, 0x8a, 0x93, 0xa1, 0xc5, 0x0d, 0x1a,
-  0x34, 0x68, 0xd0, 0x27, 0x4e, 0x9c, 0xbf, 0xf9, 0x75, 0xea, 0x53, 0xa6, 0xcb, 0x11, 0x22, 0x44,
-  0x88, 0x97, 0xa9, 0xd5, 0x2d, 0x5a, 0xb4, 0xef, 0x59, 0xb2, 0xe3, 0x41, 0x82, 0x83, 0x81, 0x85,
-  0x8d, 0x9d, 0xbd, 0xfd, 0x7d, 0xfa, 0x73, 0xe6, 0x4b, 0x96, 0xab, 0xd1, 0x25, 0x4a, 0x94, 0xaf,
-  0xd9, 0x35, 0x6a, 0xd4, 0x2f, 0x5e, 0xbc, 0xff, 0x79, 0xf2, 0x63, 0xc6, 0x0b, 0x16, 0x2c, 0x58,
-  0xb0, 0xe7, 0x49, 0x92, 0xa3, 0xc1, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0xc7, 0x09, 0x12, 0x24,
-  0x48, 0x90, 0xa7, 0xc9, 0x15, 0x2a, 0x54, 0xa8, 0xd7, 0x29, 0x52, 0xa4, 0xcf, 0x19, 0x32, 0x64,
-  0xc8, 0x17, 0x2e, 0x5c, 0xb8, 0xf7, 0x69, 0xd2, 0x23, 0x46, 0x8c, 0x9f, 0xb9, 0xf5, 0x6d, 0xda,
-  0x33, 0x66, 0xcc, 0x1f, 0x3e, 0x7c, 0xf8, 0x77, 0xee, 0x5b, 0xb6, 0xeb, 0x51, 0xa2, 0xc3, 0x00,
-};
-
-static const uint8_t Index_of[] = {
- 0xff, 0x00, 0x01, 0x63, 0x02, 0xc6, 0x64, 0x6a, 0x03, 0xcd, 0xc7, 0xbc, 0x65, 0x7e, 0x6b, 0x2a,
- 0x04, 0x8d, 0xce, 0x4e, 0xc8, 0xd4, 0xbd, 0xe1, 0x66, 0xdd, 0x7f, 0x31, 0x6c, 0x20, 0x2b, 0xf3,
- 0x05, 0x57, 0x8e, 0xe8, 0xcf, 0xac, 0x4f, 0x83, 0xc9, 0xd9, 0xd5, 0x41, 0xbe, 0x94, 0xe2, 0xb4,
- 0x67, 0x27, 0xde, 0xf0, 0x80, 0xb1, 0x32, 0x35, 0x6d, 0x45, 0x21, 0x12, 0x2c, 0x0d, 0xf4, 0x38,
- 0x06, 0x9b, 0x58, 0x1a, 0x8f, 0x79, 0xe9, 0x70, 0xd0, 0xc2, 0xad, 0xa8, 0x50, 0x75, 0x84, 0x48,
- 0xca, 0xfc, 0xda, 0x8a, 0xd6, 0x54, 0x42, 0x24, 0xbf, 0x98, 0x95, 0xf9, 0xe3, 0x5e, 0xb5, 0x15,
- 0x68, 0x61, 0x28, 0xba, 0xdf, 0x4c, 0xf1, 0x2f, 0x81, 0xe6, 0xb2, 0x3f, 0x33, 0xee, 0x36, 0x10,
- 0x6e, 0x18, 0x46, 0xa6, 0x22, 0x88, 0x13, 0xf7, 0x2d, 0xb8, 0x0e, 0x3d, 0xf5, 0xa4, 0x39, 0x3b,
- 0x07, 0x9e, 0x9c, 0x9d, 0x59, 0x9f, 0x1b, 0x08, 0x90, 0x09, 0x7a, 0x1c, 0xea, 0xa0, 0x71, 0x5a,
- 0xd1, 0x1d, 0xc3, 0x7b, 0xae, 0x0a, 0xa9, 0x91, 0x51, 0x5b, 0x76, 0x72, 0x85, 0xa1, 0x49, 0xeb,
- 0xcb, 0x7c, 0xfd, 0xc4, 0xdb, 0x1e, 0x8b, 0xd2, 0xd7, 0x92, 0x55, 0xaa, 0x43, 0x0b, 0x25, 0xaf,
- 0xc0, 0x73, 0x99, 0x77, 0x96, 0x5c, 0xfa, 0x52, 0xe4, 0xec, 0x5f, 0x4a, 0xb6, 0xa2, 0x16, 0x86,
- 0x69, 0xc5, 0x62, 0xfe, 0x29, 0x7d, 0xbb, 0xcc, 0xe0, 0xd3, 0x4d, 0x8c, 0xf2, 0x1f, 0x30, 0xdc,
- 0x82, 0xab, 0xe7, 0x56, 0xb3, 0x93, 0x40, 0xd8, 0x34, 0xb0, 0xef, 0x26, 0x37, 0x0c, 0x11, 0x44,
- 0x6f, 0x78, 0x19, 0x9a, 0x47, 0x74, 0xa7, 0xc1, 0x23, 0x53, 0x89, 0xfb, 0x14, 0x5d, 0xf8, 0x97,
- 0x2e, 0x4b, 0xb9, 0x60, 0x0f, 0xed, 0x3e, 0xe5, 0xf6, 0x87, 0xa5, 0x17, 0x3a, 0xa3, 0x3c, 0xb7,
-};
-
-static inline uint8_t mod255(uint16_t x) {
-  while (x >= 255)
-    x -= 255;
-  return x;
-}
+
+#define INDEX_OF(x) ( AO40SHORT_INDEX_OF[ (x) ] )
+#define ALPHA_TO(x) ( AO40SHORT_ALPHA_TO[ (x) ] )
+#define ALPHA_TO_SUM(x, y) ( AO40SHORT_ALPHA_TO_X[ (x) + (y) ] )
+#define RS_POLY(i) ( AO40SHORT_RS_GENPOLY[AO40SHORT_NROOTS-1-(i)] )
 
 static inline uint8_t parity(uint8_t x) {
   x ^= x >> 4;
@@ -122,77 +74,193 @@ static inline uint8_t parity(uint8_t x) {
   return x & 1;
 }
 
-/* 2566 bit -> 48 bit (6 byte) x 54 row
-   (324 byte) - 26 spare bits are used as pilot bits */
-static void interleave_symbol(uint8_t c) {
+/* The 2652 bits are a matrix of AO40SHORT_INTERLEAVER_STEP_SIZE bit rows,
+   written by columns: 80 pilot bits, then the 2572 coded symbols. They are
+   first stored in the order they come, bit_count counting them, and
+   interleave_frame() transposes them into rows at the end. */
+#define AO40SHORT_INTERLEAVER_ROWS (AO40SHORT_INTERLEAVER_SIZE_BITS / AO40SHORT_INTERLEAVER_STEP_SIZE)
+
+static void interleave_symbol(struct ao40short_encoder *e, uint8_t c) {
 #if (AO40SHORT_DEBUG_MODE >= 3)
-  printf("%4d: %3d - %02x > %d\n", bit_count, bit_count >> 3, ( 1 << ( 7 - (bit_count & 7) ) ), c != 0);
+  printf("%4d: %3d - %02x > %d\n", e->bit_count, e->bit_count >> 3, ( 1 << ( 7 - (e->bit_count & 7) ) ), c != 0);
 #endif
   if (c) {
-    Interleaver[bit_count >> 3] |= ( 1 << ( 7 - (bit_count & 7) ) );
+    e->interleaver[e->bit_count >> 3] |= ( 1 << ( 7 - (e->bit_count & 7) ) );
   } else {
-    Interleaver[bit_count >> 3] &= ~( 1 << ( 7 - (bit_count & 7) ) );
+    e->interleaver[e->bit_count >> 3] &= ~( 1 << ( 7 - (e->bit_count & 7) ) );
   }
+  ++e->bit_count;
+}
+
+// 8 bits from bit position bit on, MSB first
+static inline uint8_t get8(const uint8_t *p, uint16_t bit) {
+  return (uint8_t)(((p[bit >> 3] << 8) | p[(bit >> 3) + 1]) >> (8 - (bit & 7)));
+}
+
+// and the other way around, leaving the bits around them alone
+static inline void put8(uint8_t *p, uint16_t bit, uint8_t x) {
+  uint16_t w = (uint16_t)x << (8 - (bit & 7));
+  uint16_t mask = (uint16_t)0xff00 >> (bit & 7);
+
+  p[bit >> 3] = (p[bit >> 3] & ~(mask >> 8)) | (w >> 8);
+  p[(bit >> 3) + 1] = (p[(bit >> 3) + 1] & ~mask) | (w & 0xff);
+}
 
-  bit_count += AO40SHORT_INTERLEAVER_STEP_SIZE;
-  if (bit_count >= AO40SHORT_INTERLEAVER_SIZE_BITS) {
-    bit_count -= (AO40SHORT_INTERLEAVER_SIZE_BITS - 1);
+// 8x8 bit matrix transpose, rows as the bytes of x from the MSB
+static inline uint64_t transpose8(uint64_t x) {
+  uint64_t t;
+
+  t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+static void interleave_frame(struct ao40short_encoder *e) {
+  uint8_t in[AO40SHORT_INTERLEAVER_SIZE_BYTES + 1];  // get8() slack
+  uint8_t r0, rb, c0, cb, m;
+  uint16_t i;
+  uint64_t x;
+
+  for (i = 0; i < AO40SHORT_INTERLEAVER_SIZE_BYTES; ++i) {
+    in[i] = e->interleaver[i];
+  }
+  in[i] = 0;
+
+  // 8x8 blocks; the last row and column blocks overlap the ones before them
+  for (r0 = 0; r0 < AO40SHORT_INTERLEAVER_ROWS; r0 += 8) {
+    rb = (r0 + 8 > AO40SHORT_INTERLEAVER_ROWS) ? AO40SHORT_INTERLEAVER_ROWS - 8 : r0;
+    for (c0 = 0; c0 < AO40SHORT_INTERLEAVER_STEP_SIZE; c0 += 8) {
+      cb = (c0 + 8 > AO40SHORT_INTERLEAVER_STEP_SIZE) ? AO40SHORT_INTERLEAVER_STEP_SIZE - 8 : c0;
+      x = 0;
+      for (m = 0; m < 8; ++m) {
+        x = (x << 8) | get8(in, (cb + m) * AO40SHORT_INTERLEAVER_ROWS + rb);
+      }
+      x = transpose8(x);
+      for (m = 0; m < 8; ++m) {
+        put8(e->interleaver, (rb + m) * AO40SHORT_INTERLEAVER_STEP_SIZE + cb, (uint8_t)(x >> (56 - 8*m)));
+      }
+    }
   }
 }
 
-static void encode_and_interleave(uint8_t c, uint8_t cnt) {
-  while(cnt-- != 0){
-    // Data is processed by MSB bit first
-    Conv_sr = (Conv_sr << 1) | (c >> 7);
-    c <<= 1;
-    interleave_symbol(parity(Conv_sr & AO40SHORT_CPOLYA));
+// [state][nibble]: the 8 symbols of 4 input bits, the first one in the MSB.
+// The state is the last 6 input bits, all the K=7 code remembers.
+static uint8_t Conv_tab[64][16];
+
+__attribute__ ((constructor))
+static void init_conv_tab(void) {
+  uint8_t state, x, i, sr, sym;
+
+  for (state = 0; state < 64; ++state) {
+    for (x = 0; x < 16; ++x) {
+      sr = state;
+      sym = 0;
+      for (i = 0; i < 4; ++i) {
+        // Data is processed by MSB bit first
+        sr = (sr << 1) | ((x >> (3-i)) & 1);
 #ifndef AO40SHORT_DEBUG_MODE
-    interleave_symbol(!parity(Conv_sr & AO40SHORT_CPOLYB)); /* Second encoder symbol is inverted */
+        sym = (sym << 2) | (parity(sr & AO40SHORT_CPOLYA) << 1) | !parity(sr & AO40SHORT_CPOLYB); /* Second encoder symbol is inverted */
 #else
-    interleave_symbol(parity(Conv_sr & AO40SHORT_CPOLYB)); // hide so many bit-flips...
+        sym = (sym << 2) | (parity(sr & AO40SHORT_CPOLYA) << 1) | parity(sr & AO40SHORT_CPOLYB); // hide so many bit-flips...
 #endif
-  }    
+      }
+      Conv_tab[state][x] = sym;
+    }
+  }
 }
 
-static void scramble_and_encode(uint8_t c) {
-  uint8_t i;
+static void encode_and_interleave(struct ao40short_encoder *e, uint8_t c, uint8_t cnt) {
+  uint8_t n, sym;
+
+  // a nibble per lookup; conv_sr holds the 6 bit state only
+  while (cnt != 0) {
+    n = (cnt < 4) ? cnt : 4;
+    sym = Conv_tab[e->conv_sr][c >> 4];
+    e->conv_sr = ((e->conv_sr << n) | (c >> (8-n))) & 0x3f;
+    c <<= 4;
+    cnt -= n;
+    // whole bytes: the 80 pilot bits come before the symbols
+    e->interleaver[e->bit_count >> 3] = sym & (0xff << (8 - 2*n));
+    e->bit_count += 2*n;
+  }
+}
+
+static void scramble_and_encode(struct ao40short_encoder *e, uint8_t c) {
 #ifndef AO40SHORT_DEBUG_MODE
-  c ^= Scrambler;
+  c ^= ao40short_Scrambler[e->nbytes];
 #endif
-  // May be unroll-able... (if code size is ok)
-  for (i = 0; i < 8; ++i) {
-    Scrambler = (Scrambler << 1) | parity(Scrambler & AO40SHORT_SCRAMBLER_POLY);
-  }
-  encode_and_interleave(c, 8);
+  ++e->nbytes;
+  encode_and_interleave(e, c, 8);
 }
 
-static void encode_byte(uint8_t c){
+static void encode_byte(struct ao40short_encoder *e, uint8_t c){
   uint8_t i;
-  uint8_t feedback;
+#if defined(AO40SHORT_RS_ENC_TABLE)
+  const uint8_t *row;
+  uint8_t reg[AO40SHORT_NROOTS];
+
+  // the whole update of the feedback byte in one row, added as it shifts;
+  // shifting into a local copy lets the compiler XOR it as whole vectors
+  row = AO40SHORT_RS_ENC[c ^ e->rs_block[0]];
+  for (i = 0; i < AO40SHORT_NROOTS-1; ++i) {
+    reg[i] = e->rs_block[i+1];
+  }
+  reg[AO40SHORT_NROOTS-1] = 0;
+  for (i = 0; i < AO40SHORT_NROOTS; ++i) {
+    reg[i] ^= row[i];
+  }
+  for (i = 0; i < AO40SHORT_NROOTS; ++i) {
+    e->rs_block[i] = reg[i];
+  }
+#elif defined(AO40SHORT_GF_MUL_TABLE)
   uint8_t t;
+  const uint8_t *row;
+
+  // poly-form feedback: its row of the product table has all the terms
+  row = AO40SHORT_GF_MUL[c ^ e->rs_block[0]];
+  for (i = 0; i < AO40SHORT_NROOTS/2-1; ++i) {
+    t = row[ALPHA_TO(RS_POLY(i))];
+    e->rs_block[i+1] ^= t;
+    e->rs_block[AO40SHORT_NROOTS-1-i] ^= t;
+  }
+  e->rs_block[AO40SHORT_NROOTS/2] ^= row[ALPHA_TO(RS_POLY(AO40SHORT_NROOTS/2-1))];
 
-  feedback = INDEX_OF(c ^ RS_block[0]);
+  for (i = 0; i < AO40SHORT_NROOTS-1; ++i) {
+    e->rs_block[i] = e->rs_block[i+1];
+  }
+  e->rs_block[AO40SHORT_NROOTS-1] = row[1];
+#else
+  uint8_t t;
+  uint8_t feedback;
+
+  feedback = INDEX_OF(c ^ e->rs_block[0]);
   
+  // the generator polynomial is symmetric: its terms i+1 and NROOTS-1-i match
   if (feedback != AO40SHORT_A0){
-    for (i = 0; i < 15; ++i) {
-      t = ALPHA_TO(mod255(feedback + RS_poly[i]));
-      RS_block[i+1] ^= t;
-      RS_block[31-i] ^= t;
+    for (i = 0; i < AO40SHORT_NROOTS/2-1; ++i) {
+      t = ALPHA_TO_SUM(feedback, RS_POLY(i));
+      e->rs_block[i+1] ^= t;
+      e->rs_block[AO40SHORT_NROOTS-1-i] ^= t;
     }
-    RS_block[16] ^= ALPHA_TO(mod255(feedback + RS_poly[15]));
+    e->rs_block[AO40SHORT_NROOTS/2] ^= ALPHA_TO_SUM(feedback, RS_POLY(AO40SHORT_NROOTS/2-1));
   }
   
-  for (i = 0; i < 31; ++i) {
-    RS_block[i] = RS_block[i+1];
+  for (i = 0; i < AO40SHORT_NROOTS-1; ++i) {
+    e->rs_block[i] = e->rs_block[i+1];
   }
 
   if (feedback != AO40SHORT_A0) {
-    RS_block[31] = ALPHA_TO(feedback);
+    e->rs_block[AO40SHORT_NROOTS-1] = ALPHA_TO(feedback);
   } else {
-    RS_block[31] = 0;
+    e->rs_block[AO40SHORT_NROOTS-1] = 0;
   }
+#endif
 
-  scramble_and_encode(c);
+  scramble_and_encode(e, c);
 }
 
 /**** ENCODER CODE ENDED ****/
@@ -205,25 +273,24 @@ static void encode_byte(uint8_t c){
  *             It holds the encoded data in byte format
  */ 
 
-void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+void encode_begin_ao40short(struct ao40short_encoder *e, uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
   uint16_t i;
   uint16_t sr;
-  uint8_t j;
 
   // Use already allocated array to store encoded data
-  Interleaver = encoded;
+  e->interleaver = encoded;
 
-  Conv_sr = 0;
-  Scrambler = 0xff;
-  bit_count = 0;
+  e->conv_sr = 0;
+  e->nbytes = 0;
+  e->bit_count = 0;
 
-  for (i = 0; i < 32; ++i) {
-    RS_block[i] = 0;
+  for (i = 0; i < AO40SHORT_NROOTS; ++i) {
+    e->rs_block[i] = 0;
   }
 
   // use `memset` if it's available through other otherwise required libraries
   for (i = 0; i < AO40SHORT_INTERLEAVER_SIZE_BYTES; ++i) {
-    Interleaver[i] = 0;
+    e->interleaver[i] = 0;
   }
 
 /*
@@ -239,16 +306,35 @@ void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t enco
   printf("Interleaving %d pilot bits...\n", AO40SHORT_INTERLEAVER_PILOT_BITS);
 #endif
   for (i = 0; i < AO40SHORT_INTERLEAVER_PILOT_BITS; ++i) {
-    interleave_symbol(sr & 0x40);
+    interleave_symbol(e, sr & 0x40);
     sr = (sr << 1) | parity(sr & AO40SHORT_SYNC_POLY);
   }
+}
 
+int encode_push_ao40short(struct ao40short_encoder *e, const uint8_t *data, int n)  {
+  int i;
+
+  if (n <= 0 || e->nbytes >= AO40SHORT_DATA_SIZE) {
+    return 0;  // nothing to take, or all data in and parity comes next
+  }
+  if (n > AO40SHORT_DATA_SIZE - e->nbytes) {
+    n = AO40SHORT_DATA_SIZE - e->nbytes;
+  }
 #if (AO40SHORT_DEBUG_MODE >= 2)
-  printf("Encoding data...\n");
+  printf("Encoding %d data bytes...\n", n);
 #endif
   // RS code, convolutional code, scramble and interleave data
-  for (j = 0; j < 128; ++j) {
-    encode_byte(data[j]);
+  for (i = 0; i < n; ++i) {
+    encode_byte(e, data[i]);
+  }
+  return n;
+}
+
+void encode_finish_ao40short(struct ao40short_encoder *e)  {
+  uint8_t j;
+
+  while (e->nbytes < AO40SHORT_DATA_SIZE) {
+    encode_byte(e, 0);
   }
 
 /* // Useful if multiple separated pilot bits are required instead of
@@ -258,7 +344,7 @@ void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t enco
   printf("Interleaving remaining %d pilot bits...\n", AO40SHORT_INTERLEAVER_PILOT_BITS - AO40SHORT_INTERLEAVER_STEP_SIZE);
 #endif
   for (; i < AO40SHORT_INTERLEAVER_PILOT_BITS; ++i) {
-    interleave_symbol(sr & 0x40);
+    interleave_symbol(e, sr & 0x40);
     sr = (sr << 1) | parity(sr & AO40SHORT_SYNC_POLY);
   }
 #endif
@@ -268,35 +354,83 @@ void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t enco
   printf("Encoding parity...\n");
 #endif
   // Put the RS parity into convolutional code
-  for (j = 0; j < 32; ++j) {
-    scramble_and_encode(RS_block[j]);
+  for (j = 0; j < AO40SHORT_NROOTS; ++j) {
+    scramble_and_encode(e, e->rs_block[j]);
   }
 
 #if (AO40SHORT_DEBUG_MODE >= 2)
   printf("Encoding tail bits...\n");
 #endif
   // Convolutional code tail bits (to put SR into all-0 state)
-  encode_and_interleave(0, 6);
+  encode_and_interleave(e, 0, 6);
+
+  interleave_frame(e);
+}
+
+void encode_data_ao40short_r(struct ao40short_encoder *e, const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+  encode_begin_ao40short(e, encoded);
+  encode_push_ao40short(e, data, AO40SHORT_DATA_SIZE);
+  encode_finish_ao40short(e);
+}
+
+void encode_data_ao40short_parity_r(struct ao40short_encoder *e, const uint8_t data[AO40SHORT_DATA_SIZE], const uint8_t parity[AO40SHORT_NROOTS], uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+  uint8_t j;
+
+  encode_begin_ao40short(e, encoded);
+  for (j = 0; j < AO40SHORT_DATA_SIZE; ++j) {
+    scramble_and_encode(e, data[j]);
+  }
+  for (j = 0; j < AO40SHORT_NROOTS; ++j) {
+    e->rs_block[j] = parity[j];
+  }
+  encode_finish_ao40short(e);
+}
+
+void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+  struct ao40short_encoder e;
+
+  encode_data_ao40short_r(&e, data, encoded);
+}
+
+int encode_data_ao40short_iov_r(struct ao40short_encoder *e, const struct ao40short_iovec iov[], int iovcnt, uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+  size_t total = 0;
+  int i;
+
+  // fragment by fragment, so that neither total nor the int length wraps
+  for (i = 0; i < iovcnt; ++i) {
+    if (iov[i].len > AO40SHORT_DATA_SIZE - total) {
+      return -1;
+    }
+    total += iov[i].len;
+  }
+  if (total != AO40SHORT_DATA_SIZE) {
+    return -1;
+  }
+
+  encode_begin_ao40short(e, encoded);
+  for (i = 0; i < iovcnt; ++i) {
+    encode_push_ao40short(e, iov[i].base, (int)iov[i].len);  // at most AO40SHORT_DATA_SIZE each
+  }
+  encode_finish_ao40short(e);
+  return 0;
+}
+
+int encode_data_ao40short_iov(const struct ao40short_iovec iov[], int iovcnt, uint8_t encoded[AO40SHORT_CODE_LENGTH])  {
+  struct ao40short_encoder e;
+
+  return encode_data_ao40short_iov_r(&e, iov, iovcnt, encoded);
 }
 
 // for testing purpose enable built-in byte->bit converter
 #ifdef AO40SHORT_ENABLE_BIT_OUTPUT
-void encode_short_data_bit(uint8_t *data, uint8_t *bit_encoded) {
-  uint8_t encoded[AO40SHORT_INTERLEAVER_SIZE_BYTES];
-  memset(encoded, 0, AO40SHORT_INTERLEAVER_SIZE_BYTES);
-  uint16_t i;
-  // encode to byte format
-  encode_short_data(data, encoded);
+void encode_short_data_bit(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t bit_encoded[AO40SHORT_CODE_BITS]) {
+  uint8_t encoded[AO40SHORT_CODE_LENGTH];
 
-  // convert to bit format: simply put 0 and 1 to the corresponding byte
-  for (i = 0; i < (AO40SHORT_INTERLEAVER_SIZE_BYTES*8); ++i) {
+  encode_data_ao40short(data, encoded);
 #ifdef MSBFIRST
-    // MSB first
-    bit_encoded[i] = ( (encoded[i >> 3] & (1 << (7 - (i & 7)))) != 0 );
+  ao40short_unpack_bits(encoded, bit_encoded, AO40SHORT_MSB_FIRST);
 #else
-    // LSB first
-    bit_encoded[i] = ( (encoded[i >> 3] & (1 << (i & 7))) != 0 );
+  ao40short_unpack_bits(encoded, bit_encoded, AO40SHORT_LSB_FIRST);
 #endif
-  }
 }
 #endif
@@ -1,18 +1,106 @@
 #ifndef AO40SHORT_ENC_H
 #define AO40SHORT_ENC_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "ao40short_gf.h"
+
 #define AO40SHORT_DATA_SIZE      128
 #define AO40SHORT_CODE_LENGTH    332
 
+//#define AO40SHORT_ENABLE_THREADS  // encode_data_ao40short_mt(), needs -pthread
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 void encode_data_ao40short(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH]);
 
+/* Encoder state: the _r functions keep all of it here, so separate encoders
+ * can encode in parallel. encode_data_ao40short() keeps one on the stack.
+ */
+struct ao40short_encoder {
+  uint8_t rs_block[AO40SHORT_NROOTS];  // parity of the RS word
+  uint16_t bit_count;    // symbols written so far
+  uint8_t nbytes;        // RS bytes coded so far
+  uint8_t conv_sr;       // convolutional encoder state
+  uint8_t *interleaver;  // the output
+};
+void encode_data_ao40short_r(struct ao40short_encoder *e, const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH]);
+
+/* The same a few bytes at a time, as the payload is put together: begin,
+ * push the data bytes in any pieces, then finish writes the parity and
+ * completes encoded. Push returns the bytes it took, those up to
+ * AO40SHORT_DATA_SIZE in all, and 0 for n < 0; finish takes zeros for the
+ * ones not pushed. encoded holds the frame only after finish: push stores
+ * the coded symbols there in column order, and finish does the whole
+ * interleaver transpose into rows. */
+void encode_begin_ao40short(struct ao40short_encoder *e, uint8_t encoded[AO40SHORT_CODE_LENGTH]);
+int encode_push_ao40short(struct ao40short_encoder *e, const uint8_t *data, int n);
+void encode_finish_ao40short(struct ao40short_encoder *e);
+
+/* Payload in pieces, as struct iovec: the fragments are read in place, in
+ * order, and must add up to AO40SHORT_DATA_SIZE bytes. Returns 0, or -1 with
+ * nothing written if they do not. */
+struct ao40short_iovec {
+  const void *base;
+  size_t len;
+};
+int encode_data_ao40short_iov(const struct ao40short_iovec iov[], int iovcnt, uint8_t encoded[AO40SHORT_CODE_LENGTH]);
+int encode_data_ao40short_iov_r(struct ao40short_encoder *e, const struct ao40short_iovec iov[], int iovcnt, uint8_t encoded[AO40SHORT_CODE_LENGTH]);
+
+/* As encode_data_ao40short_r(), the parity of the RS word formed already */
+void encode_data_ao40short_parity_r(struct ao40short_encoder *e, const uint8_t data[AO40SHORT_DATA_SIZE], const uint8_t parity[AO40SHORT_NROOTS], uint8_t encoded[AO40SHORT_CODE_LENGTH]);
+
+/* Encodes n frames, byte-identical to encode_data_ao40short() on each.
+ * From the SSSE3 level of ao40short_cpu.h on the RS parity of
+ * AO40SHORT_ENC_BATCH frames is formed at once, one frame per vector lane,
+ * see ao40short_enc_batch.c. AO40SHORT_KERNEL and ao40short_set_kernel() pin
+ * the level as for the decoder.
+ */
+#define AO40SHORT_ENC_BATCH 64  // frames per round, an AVX-512 vector of them
+void encode_data_ao40short_batch(const uint8_t *const data[], uint8_t *const encoded[], int n);
+
+#ifdef AO40SHORT_ENABLE_THREADS
+/* As encode_data_ao40short_batch(), the rounds spread over threads (0: one
+ * per online CPU), at most one per round. Worth it from a few hundred
+ * frames on. */
+void encode_data_ao40short_mt(const uint8_t *const data[], uint8_t *const encoded[], int n, int threads);
+#endif
+
+/* Incremental encoding, see ao40short_enc_delta.c: bit[p][b] is what flipping
+ * bit b (0: MSB) of payload byte p flips in the encoded frame. Create the
+ * table once (about 340 KB, a few ms to build) and share it read-only. */
+struct ao40short_enc_delta {
+  uint8_t bit[AO40SHORT_DATA_SIZE][8][AO40SHORT_CODE_LENGTH];
+};
+
+struct ao40short_enc_delta *ao40short_create_enc_delta(void);  // NULL if out of memory
+void ao40short_delete_enc_delta(struct ao40short_enc_delta *t);
+
+/* Sets data[offset[i]] = value[i] for the n changes in order and patches
+ * encoded, the frame of data, to match: the result is what
+ * encode_data_ao40short() makes of the new data. Returns 0, or -1 with nothing
+ * changed if an offset is out of range. */
+int encode_update_ao40short(const struct ao40short_enc_delta *t, uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH],
+                            const uint16_t offset[], const uint8_t value[], int n);
+
+/* Output formats, see ao40short_enc_out.c: the encoded frame unpacked to
+ * one symbol per element, in the order they are sent. MSB first starts
+ * with bit 7 of encoded[0], LSB first with bit 0. A 1 bit becomes 1, +amp
+ * or +1.0f and a 0 bit 0, -amp or -1.0f, as the decoder takes soft
+ * symbols; amp is 1 to 127, smaller values are taken as 1. The last 4
+ * symbols are padding. */
+#define AO40SHORT_MSB_FIRST 0
+#define AO40SHORT_LSB_FIRST 1
+#define AO40SHORT_CODE_BITS (8*AO40SHORT_CODE_LENGTH)
+
+void ao40short_unpack_bits(const uint8_t encoded[AO40SHORT_CODE_LENGTH], uint8_t bits[AO40SHORT_CODE_BITS], int order);
+void ao40short_unpack_s8(const uint8_t encoded[AO40SHORT_CODE_LENGTH], int8_t syms[AO40SHORT_CODE_BITS], int8_t amp, int order);
+void ao40short_unpack_float(const uint8_t encoded[AO40SHORT_CODE_LENGTH], float syms[AO40SHORT_CODE_BITS], int order);
+
 #ifdef AO40SHORT_ENABLE_BIT_OUTPUT
-void encode_short_data_bit(uint8_t *data, uint8_t *bit_encoded);
+void encode_short_data_bit(const uint8_t data[AO40SHORT_DATA_SIZE], uint8_t bit_encoded[AO40SHORT_CODE_BITS]);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,87 @@
+/*
+ * Incremental AO-40 short encoder
+ *
+ * RS code, convolutional code and interleaver are all linear over GF(2);
+ * only the scrambler sequence and the inverted second symbol add a fixed
+ * pattern. So encoding is affine, E(d) = L(d) ^ E(0), and
+ *
+ *   E(d ^ x) = E(d) ^ L(x)
+ *
+ * with L(x) the XOR of L over the set bits of x. The table keeps L of every
+ * single payload bit, L(bit) = E(bit) ^ E(0), and a changed byte patches
+ * the frame with the rows of the bits it flips.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "ao40short_enc.h"
+
+struct ao40short_enc_delta *ao40short_create_enc_delta(void) {
+  struct ao40short_enc_delta *t;
+  uint8_t data[AO40SHORT_ENC_BATCH][AO40SHORT_DATA_SIZE];
+  const uint8_t *dp[AO40SHORT_ENC_BATCH];
+  uint8_t *ep[AO40SHORT_ENC_BATCH];
+  uint8_t zero[AO40SHORT_CODE_LENGTH];
+  int p, i, m, k;
+
+  if ((t = malloc(sizeof(*t))) == 0)
+    return 0;
+
+  memset(data, 0, sizeof(data));
+  encode_data_ao40short(data[0], zero);
+
+  // the bits in order, AO40SHORT_ENC_BATCH frames of a single set bit per round
+  for (p = 0; p < AO40SHORT_DATA_SIZE*8; p += m) {
+    m = (AO40SHORT_DATA_SIZE*8 - p < AO40SHORT_ENC_BATCH) ? AO40SHORT_DATA_SIZE*8 - p : AO40SHORT_ENC_BATCH;
+    for (i = 0; i < m; ++i) {
+      k = p + i;
+      memset(data[i], 0, AO40SHORT_DATA_SIZE);
+      data[i][k >> 3] = 0x80 >> (k & 7);
+      dp[i] = data[i];
+      ep[i] = t->bit[k >> 3][k & 7];
+    }
+    encode_data_ao40short_batch(dp, ep, m);
+    for (i = 0; i < m; ++i) {
+      for (k = 0; k < AO40SHORT_CODE_LENGTH; ++k)
+        ep[i][k] ^= zero[k];
+    }
+  }
+  return t;
+}
+
+void ao40short_delete_enc_delta(struct ao40short_enc_delta *t) {
+  free(t);
+}
+
+/* The bulk in whole 16 byte blocks, which the compiler vectorizes at -O2 */
+static inline void ao40short_xor_row(uint8_t *restrict out, const uint8_t *restrict row) {
+  int k;
+
+  for (k = 0; k < AO40SHORT_CODE_LENGTH/16*16; ++k)
+    out[k] ^= row[k];
+  for (; k < AO40SHORT_CODE_LENGTH; ++k)
+    out[k] ^= row[k];
+}
+
+int encode_update_ao40short(const struct ao40short_enc_delta *t, uint8_t data[AO40SHORT_DATA_SIZE], uint8_t encoded[AO40SHORT_CODE_LENGTH],
+                            const uint16_t offset[], const uint8_t value[], int n) {
+  uint8_t x;
+  int i, b;
+
+  for (i = 0; i < n; ++i) {
+    if (offset[i] >= AO40SHORT_DATA_SIZE)
+      return -1;
+  }
+
+  for (i = 0; i < n; ++i) {
+    x = data[offset[i]] ^ value[i];
+    data[offset[i]] = value[i];
+    for (b = 0; x != 0; ++b, x <<= 1) {
+      if ((x & 0x80) == 0)
+        continue;
+      ao40short_xor_row(encoded, t->bit[offset[i]][b]);
+    }
+  }
+  return 0;
+}
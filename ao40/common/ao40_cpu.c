@@ -0,0 +1,65 @@
+/*
+ * CPU feature level of the AO-40 encoder and decoder kernels
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ao40_cpu.h"
+
+static const char *const ao40_kernel_names[AO40_KERNEL_COUNT] = {
+  "scalar", "sse2", "ssse3", "avx2", "avx512bw"
+};
+
+static ao40_kernel_t ao40_active_kernel = AO40_KERNEL_SCALAR;
+
+ao40_kernel_t ao40_cpu_kernel(void) {
+#ifdef AO40_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw"))
+    return AO40_KERNEL_AVX512BW;
+  if (__builtin_cpu_supports("avx2"))
+    return AO40_KERNEL_AVX2;
+  if (__builtin_cpu_supports("ssse3"))
+    return AO40_KERNEL_SSSE3;
+  if (__builtin_cpu_supports("sse2"))
+    return AO40_KERNEL_SSE2;
+#endif
+  return AO40_KERNEL_SCALAR;
+}
+
+ao40_kernel_t ao40_get_kernel(void) {
+  return ao40_active_kernel;
+}
+
+int ao40_set_kernel(ao40_kernel_t kernel) {
+  ao40_kernel_t best = ao40_cpu_kernel();
+
+  if (kernel == AO40_KERNEL_AUTO)
+    kernel = best;
+  if (kernel < AO40_KERNEL_SCALAR || kernel > best)
+    return -1;
+
+  ao40_active_kernel = kernel;
+  return 0;
+}
+
+const char *ao40_kernel_name(ao40_kernel_t kernel) {
+  if (kernel < AO40_KERNEL_SCALAR || kernel >= AO40_KERNEL_COUNT)
+    return "auto";
+  return ao40_kernel_names[kernel];
+}
+
+/* Pick the level before main(): AO40_KERNEL overrides the CPU check */
+__attribute__ ((constructor))
+static void ao40_cpu_init(void) {
+  const char *env = getenv("AO40_KERNEL");
+  int i;
+
+  if (env != NULL) {
+    for (i = 0; i < AO40_KERNEL_COUNT; ++i) {
+      if (strcmp(env, ao40_kernel_names[i]) == 0 && ao40_set_kernel((ao40_kernel_t)i) == 0)
+        return;
+    }
+  }
+  ao40_set_kernel(AO40_KERNEL_AUTO);
+}
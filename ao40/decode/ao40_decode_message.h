@@ -3,11 +3,28 @@
 
 #include <stdint.h>
 #include "ao40_spiral-vit_scalar.h"
+#include "ao40_dispatch.h"
 #include "ao40_decode_rs.h"
+#include "ao40_vit_list.h"
+#include "ao40_vit_sova.h"
 
 #define AO40_DEBUG
+//#define AO40_VITERBI_8BIT  // 8-bit SIMD metrics, frames failing RS are re-run with exact 16-bit metrics
+#ifndef AO40_LIST_SIZE
+#define AO40_LIST_SIZE 1     // paths tried by the list Viterbi when RS fails on the best one, 1: off
+#endif
+#ifndef AO40_ERASURES
+#define AO40_ERASURES 0      // least reliable bytes erased per RS block when RS fails, 0: off
+#endif
+#ifndef AO40_ERASURE_THRESHOLD
+#define AO40_ERASURE_THRESHOLD 128  // SOVA reliability a byte must be below to be erased (255: one symbol flipped)
+#endif
+#define AO40_ERASURE_STEP 4  // erasures added per RS retry
+#define AO40_ERASURES_MAX (AO40_NROOTS-8)
 
 #define AO40_RAW_SIZE      5200
+#define AO40_RAW_ROWS        65  // interleaver matrix: written by rows,
+#define AO40_RAW_COLS        80  // read by columns
 #define AO40_CONV_SIZE     5132
 
 #define AO40_RS_SIZE        320
@@ -16,6 +33,8 @@
 #define AO40_FRAME_BITS    2560
 #define AO40_RS_BLOCK_SIZE  160
 
+#define AO40_VITERBI_BATCH   32  // frames per ao40_decode_data_batch() round, the widest batch kernel
+
 #if !defined(AO40_NULL)
 #define AO40_NULL ((void *)0)
 #endif
@@ -24,9 +43,37 @@
 extern "C" {
 #endif // __cplusplus
 
-extern const uint8_t ao40_Scrambler[320];
+/* Decoder state: create it once and reuse it for any number of frames
+ * through the _r functions. A decoder serves one thread at a time,
+ * separate decoders can decode in parallel. A struct ao40_decoder is
+ * about 21 KB: the _r functions leave it to the caller where it lives, on
+ * the stack only if that has room. The functions without _r allocate and
+ * free one on the heap per call, a malloc() and free() of that size for
+ * every frame; decoding a stream, create one decoder and use the _r
+ * functions. If that allocation fails, ao40_viterbi() returns -1 and the
+ * ao40_decode_data() functions report error -1 on both RS blocks.
+ */
+struct ao40_decoder {
+  struct ao40_v vp;
+  // ao40_decision_t rows, its alignment does not allow a plain array
+  __attribute__ ((aligned (16))) uint32_t decisions[(AO40_FRAMEBITS+(AO40_K-1))*AO40_NUMSTATES/32];
+  int list_size;  // paths tried when RS fails, AO40_LIST_SIZE by default
+  int erasures;   // bytes erased per RS block when RS fails, AO40_ERASURES by default
+  uint16_t erasure_threshold;  // AO40_ERASURE_THRESHOLD by default
+};
+
+struct ao40_decoder *ao40_create_decoder(void);  // NULL if out of memory
+void ao40_delete_decoder(struct ao40_decoder *d);
 
+void ao40_deinterleave(uint8_t raw[AO40_RAW_SIZE], uint8_t conv[AO40_CONV_SIZE]);
+int ao40_viterbi(uint8_t conv[AO40_CONV_SIZE], uint8_t dec_data[AO40_RS_SIZE]);
+void ao40_viterbi_r(struct ao40_decoder *d, uint8_t conv[AO40_CONV_SIZE], uint8_t dec_data[AO40_RS_SIZE]);
+void ao40_viterbi_s8_r(struct ao40_decoder *d, const int8_t conv[AO40_CONV_SIZE], uint8_t dec_data[AO40_RS_SIZE]);
+void ao40_viterbi_soft_r(struct ao40_decoder *d, uint8_t conv[AO40_CONV_SIZE], uint8_t dec_data[AO40_RS_SIZE], uint16_t rel[AO40_RS_SIZE]);
+int ao40_viterbi_batch(uint8_t *const conv[], uint8_t *const dec_data[], int n);
 void ao40_decode_data(uint8_t raw[AO40_RAW_SIZE], uint8_t data[AO40_DATA_SIZE], int8_t error[2]);
+void ao40_decode_data_r(struct ao40_decoder *d, uint8_t raw[AO40_RAW_SIZE], uint8_t data[AO40_DATA_SIZE], int8_t error[2]);
+int ao40_decode_data_batch(uint8_t *const raw[], uint8_t *const data[], int8_t (*error)[2], int n);
 
 #ifdef AO40_DEBUG
 void ao40_decode_data_debug(uint8_t raw[AO40_RAW_SIZE], uint8_t data[AO40_DATA_SIZE], int8_t  error[2], uint8_t conv[AO40_CONV_SIZE], uint8_t dec_data[AO40_RS_SIZE], uint8_t rs[2][AO40_RS_BLOCK_SIZE]);
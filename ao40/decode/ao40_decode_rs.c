@@ -1,7 +1,11 @@
 #include "ao40_decode_rs.h"
+#include "ao40_dispatch.h"
 
 #include <stdint.h>
 #include <string.h>
+#if DEBUG >= 1
+#include <stdio.h>
+#endif
 
 #if !defined(AO40_NROOTS)
 #error "AO40_NROOTS not defined"
@@ -33,72 +37,202 @@
 
 #undef AO40_MIN
 #define AO40_MIN(a,b) ((a) < (b) ? (a) : (b))
-#undef AO40_A0
-#define AO40_A0 (AO40_NN)
-
-const uint8_t AO40_INDEX_OF[] = {
-   0xff, 0x00, 0x01, 0x63, 0x02, 0xc6, 0x64, 0x6a, 0x03, 0xcd, 0xc7, 0xbc, 0x65, 0x7e, 0x6b, 0x2a,
-   0x04, 0x8d, 0xce, 0x4e, 0xc8, 0xd4, 0xbd, 0xe1, 0x66, 0xdd, 0x7f, 0x31, 0x6c, 0x20, 0x2b, 0xf3,
-   0x05, 0x57, 0x8e, 0xe8, 0xcf, 0xac, 0x4f, 0x83, 0xc9, 0xd9, 0xd5, 0x41, 0xbe, 0x94, 0xe2, 0xb4,
-   0x67, 0x27, 0xde, 0xf0, 0x80, 0xb1, 0x32, 0x35, 0x6d, 0x45, 0x21, 0x12, 0x2c, 0x0d, 0xf4, 0x38,
-   0x06, 0x9b, 0x58, 0x1a, 0x8f, 0x79, 0xe9, 0x70, 0xd0, 0xc2, 0xad, 0xa8, 0x50, 0x75, 0x84, 0x48,
-   0xca, 0xfc, 0xda, 0x8a, 0xd6, 0x54, 0x42, 0x24, 0xbf, 0x98, 0x95, 0xf9, 0xe3, 0x5e, 0xb5, 0x15,
-   0x68, 0x61, 0x28, 0xba, 0xdf, 0x4c, 0xf1, 0x2f, 0x81, 0xe6, 0xb2, 0x3f, 0x33, 0xee, 0x36, 0x10,
-   0x6e, 0x18, 0x46, 0xa6, 0x22, 0x88, 0x13, 0xf7, 0x2d, 0xb8, 0x0e, 0x3d, 0xf5, 0xa4, 0x39, 0x3b,
-   0x07, 0x9e, 0x9c, 0x9d, 0x59, 0x9f, 0x1b, 0x08, 0x90, 0x09, 0x7a, 0x1c, 0xea, 0xa0, 0x71, 0x5a,
-   0xd1, 0x1d, 0xc3, 0x7b, 0xae, 0x0a, 0xa9, 0x91, 0x51, 0x5b, 0x76, 0x72, 0x85, 0xa1, 0x49, 0xeb,
-   0xcb, 0x7c, 0xfd, 0xc4, 0xdb, 0x1e, 0x8b, 0xd2, 0xd7, 0x92, 0x55, 0xaa, 0x43, 0x0b, 0x25, 0xaf,
-   0xc0, 0x73, 0x99, 0x77, 0x96, 0x5c, 0xfa, 0x52, 0xe4, 0xec, 0x5f, 0x4a, 0xb6, 0xa2, 0x16, 0x86,
-   0x69, 0xc5, 0x62, 0xfe, 0x29, 0x7d, 0xbb, 0xcc, 0xe0, 0xd3, 0x4d, 0x8c, 0xf2, 0x1f, 0x30, 0xdc,
-   0x82, 0xab, 0xe7, 0x56, 0xb3, 0x93, 0x40, 0xd8, 0x34, 0xb0, 0xef, 0x26, 0x37, 0x0c, 0x11, 0x44,
-   0x6f, 0x78, 0x19, 0x9a, 0x47, 0x74, 0xa7, 0xc1, 0x23, 0x53, 0x89, 0xfb, 0x14, 0x5d, 0xf8, 0x97,
-   0x2e, 0x4b, 0xb9, 0x60, 0x0f, 0xed, 0x3e, 0xe5, 0xf6, 0x87, 0xa5, 0x17, 0x3a, 0xa3, 0x3c, 0xb7,
-};
-
-const uint8_t AO40_ALPHA_TO[] = {
-    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x87, 0x89, 0x95, 0xad, 0xdd, 0x3d, 0x7a, 0xf4,
-    0x6f, 0xde, 0x3b, 0x76, 0xec, 0x5f, 0xbe, 0xfb, 0x71, 0xe2, 0x43, 0x86, 0x8b, 0x91, 0xa5, 0xcd,
-    0x1d, 0x3a, 0x74, 0xe8, 0x57, 0xae, 0xdb, 0x31, 0x62, 0xc4, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0x67,
-    0xce, 0x1b, 0x36, 0x6c, 0xd8, 0x37, 0x6e, 0xdc, 0x3f, 0x7e, 0xfc, 0x7f, 0xfe, 0x7b, 0xf6, 0x6b,
-    0xd6, 0x2b, 0x56, 0xac, 0xdf, 0x39, 0x72, 0xe4, 0x4f, 0x9e, 0xbb, 0xf1, 0x65, 0xca, 0x13, 0x26,
-    0x4c, 0x98, 0xb7, 0xe9, 0x55, 0xaa, 0xd3, 0x21, 0x42, 0x84, 0x8f, 0x99, 0xb5, 0xed, 0x5d, 0xba,
-    0xf3, 0x61, 0xc2, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
-    0x47, 0x8e, 0x9b, 0xb1, 0xe5, 0x4d, 0x9a, 0xb3, 0xe1, 0x45, 0x8a, 0x93, 0xa1, 0xc5, 0x0d, 0x1a,
-    0x34, 0x68, 0xd0, 0x27, 0x4e, 0x9c, 0xbf, 0xf9, 0x75, 0xea, 0x53, 0xa6, 0xcb, 0x11, 0x22, 0x44,
-    0x88, 0x97, 0xa9, 0xd5, 0x2d, 0x5a, 0xb4, 0xef, 0x59, 0xb2, 0xe3, 0x41, 0x82, 0x83, 0x81, 0x85,
-    0x8d, 0x9d, 0xbd, 0xfd, 0x7d, 0xfa, 0x73, 0xe6, 0x4b, 0x96, 0xab, 0xd1, 0x25, 0x4a, 0x94, 0xaf,
-    0xd9, 0x35, 0x6a, 0xd4, 0x2f, 0x5e, 0xbc, 0xff, 0x79, 0xf2, 0x63, 0xc6, 0x0b, 0x16, 0x2c, 0x58,
-    0xb0, 0xe7, 0x49, 0x92, 0xa3, 0xc1, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0xc7, 0x09, 0x12, 0x24,
-    0x48, 0x90, 0xa7, 0xc9, 0x15, 0x2a, 0x54, 0xa8, 0xd7, 0x29, 0x52, 0xa4, 0xcf, 0x19, 0x32, 0x64,
-    0xc8, 0x17, 0x2e, 0x5c, 0xb8, 0xf7, 0x69, 0xd2, 0x23, 0x46, 0x8c, 0x9f, 0xb9, 0xf5, 0x6d, 0xda,
-    0x33, 0x66, 0xcc, 0x1f, 0x3e, 0x7c, 0xf8, 0x77, 0xee, 0x5b, 0xb6, 0xeb, 0x51, 0xa2, 0xc3, 0x00,
-};
 
-int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
-  int deg_lambda, el, deg_omega;
-  int i, j, r,k;
-  uint8_t u,q,tmp,num1,num2,den,discr_r;
-  uint8_t lambda[AO40_NROOTS+1], s[AO40_NROOTS];        /* Err+Eras Locator poly and syndrome poly */
-  uint8_t b[AO40_NROOTS+1], t[AO40_NROOTS+1], omega[AO40_NROOTS+1];
-  uint8_t root[AO40_NROOTS], reg[AO40_NROOTS+1], loc[AO40_NROOTS];
-  int syn_error, count;
+/* Syndromes in poly-form; i.e., data(x) evaluated at the roots of g(x) */
+void ao40_rs_syndrome_scalar(const uint8_t *data, uint8_t s[AO40_NROOTS]) {
+#ifdef AO40_GF_MUL_TABLE
+  const uint8_t *root[AO40_NROOTS];  /* rows of AO40_GF_MUL */
+#else
+  uint8_t root[AO40_NROOTS];  /* index-form */
+#endif
+  int i, j;
 
-  /* form the syndromes; i.e., evaluate data(x) at roots of g(x) */
-  for (i=0;i<AO40_NROOTS;i++)
+  for (i=0;i<AO40_NROOTS;i++) {
     s[i] = data[0];
+#ifdef AO40_GF_MUL_TABLE
+    root[i] = AO40_GF_MUL[AO40_ALPHA_TO[AO40_MODNN((AO40_FCR+i)*AO40_PRIM)]];
+#else
+    root[i] = AO40_MODNN((AO40_FCR+i)*AO40_PRIM);
+#endif
+  }
 
   for (j=1;j<AO40_NN-AO40_PAD;j++) {
     for (i=0;i<AO40_NROOTS;i++) {
+#ifdef AO40_GF_MUL_TABLE
+      s[i] = data[j] ^ root[i][s[i]];
+#else
       if (s[i] == 0) {
         s[i] = data[j];
       } else {
-        s[i] = data[j] ^ AO40_ALPHA_TO[AO40_MODNN(AO40_INDEX_OF[s[i]] + (AO40_FCR+i)*AO40_PRIM)];
+        s[i] = data[j] ^ AO40_ALPHA_TO_X[AO40_INDEX_OF[s[i]] + root[i]];
       }
+#endif
+    }
+  }
+}
+
+/* Chien search: roots (index-form) and error locations of lambda(x),
+ * given in index-form. Only the AO40_NN-AO40_PAD positions the shortened
+ * code sends are tried: a root in the padding is an uncorrectable word.
+ * Position k is X = alpha^((k+1)*PRIM), so from one position to the next
+ * term j of lambda(X) gains j*PRIM in index-form. Stops after deg_lambda
+ * roots, or as soon as the positions left can not make up deg_lambda.
+ * Returns the count. */
+int ao40_rs_chien_scalar(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]) {
+  uint8_t reg[AO40_NROOTS+1];
+  uint8_t q;
+  int i, j, k;
+  int count = 0;                /* Number of roots of lambda(x) */
+
+  i = AO40_MODNN((AO40_PAD+1)*AO40_PRIM);
+  for (j = 1; j <= deg_lambda; j++)
+    reg[j] = (lambda[j] == AO40_A0) ? AO40_A0 : AO40_MODNN(lambda[j] + j*i);
+
+  for (k = AO40_PAD; k < AO40_NN; k++) {
+    if (count + (AO40_NN - k) < deg_lambda)
+      break; /* Too few positions left */
+    q = 1; /* lambda[0] is always 0 */
+    for (j = deg_lambda; j > 0; j--) {
+      if (reg[j] != AO40_A0) {
+        q ^= AO40_ALPHA_TO[reg[j]];
+        reg[j] = AO40_MODNN(reg[j] + j*AO40_PRIM);
+      }
+    }
+    if (q != 0)
+      continue; /* Not a root */
+    /* store root (index-form) and error location number */
+    i = AO40_MODNN((k+1)*AO40_PRIM);
+    root[count] = (i == 0) ? AO40_NN : i;
+    loc[count] = k;
+#if DEBUG>=2
+    printf("count %d root %d loc %d\n",count,root[count],k);
+#endif
+    /* If we've already found max possible roots,
+     * abort the search to save time
+     */
+    if (++count == deg_lambda)
+      break;
+  }
+  return count;
+}
+
+#if AO40_RS_FAST_T > 0
+#define AO40_RS_FALLBACK (-2)
+
+/* Codeword position of the error locator Y = alpha^(PRIM*(NN-1-k)),
+ * given in index-form */
+static inline int ao40_rs_small_loc(int y) {
+  return AO40_NN-1 - AO40_MODNN(y*AO40_IPRIM);
+}
+
+#if AO40_RS_FAST_T > 1
+/* Two errors: see ao40_rs_small() */
+static int ao40_rs_small2(uint8_t *data, const uint8_t s[AO40_NROOTS], uint8_t loc[2]) {
+  uint8_t S[AO40_NROOTS], Y[2], D, sigma1, sigma2, z, e;
+  int i, ls1, ls2;
+
+  for (i = 0; i < AO40_NROOTS; i++)
+    S[i] = AO40_ALPHA_TO[s[i]];
+  D = ao40_gf_mul(S[1], S[1]) ^ ao40_gf_mul(S[0], S[2]);
+  if (D == 0)
+    return AO40_RS_FALLBACK;
+  sigma1 = ao40_gf_div(ao40_gf_mul(S[1], S[2]) ^ ao40_gf_mul(S[0], S[3]), D);
+  sigma2 = ao40_gf_div(ao40_gf_mul(S[1], S[3]) ^ ao40_gf_mul(S[2], S[2]), D);
+  if (sigma1 == 0 || sigma2 == 0)
+    return AO40_RS_FALLBACK;
+  ls1 = AO40_INDEX_OF[sigma1];
+  ls2 = AO40_INDEX_OF[sigma2];
+  /* sigma solves i = 0, 1 by construction */
+  for (i = 2; i < AO40_NROOTS-2; i++) {
+    e = S[i+2];
+    if (s[i+1] != AO40_A0)
+      e ^= AO40_ALPHA_TO_X[s[i+1] + ls1];
+    if (s[i] != AO40_A0)
+      e ^= AO40_ALPHA_TO_X[s[i] + ls2];
+    if (e != 0)
+      return AO40_RS_FALLBACK;
+  }
+  /* x = sigma1 z turns the locator into z^2 + z = sigma2 / sigma1^2 */
+  z = AO40_QUAD_ROOT[AO40_ALPHA_TO[AO40_MODNN(ls2 + 2*AO40_NN - 2*ls1)]];
+  if (z == 0)
+    return AO40_RS_FALLBACK;
+  Y[0] = ao40_gf_mul(sigma1, z);
+  Y[1] = Y[0] ^ sigma1;
+  for (i = 0; i < 2; i++) {
+    loc[i] = (uint8_t)ao40_rs_small_loc(AO40_INDEX_OF[Y[i]]);
+    if (loc[i] < AO40_PAD)
+      return -1; /* In the padding */
+  }
+  /* e_i Y_i^FCR = (S_1 + Y_j S_0) / (Y_1 + Y_2) */
+  for (i = 0; i < 2; i++) {
+    e = ao40_gf_div(S[1] ^ ao40_gf_mul(Y[i^1], S[0]), sigma1);
+    data[loc[i]-AO40_PAD] ^= ao40_gf_div(e, AO40_ALPHA_TO[AO40_MODNN(AO40_FCR*AO40_INDEX_OF[Y[i]])]);
+  }
+  return 2;
+}
+#endif
+
+/* Corrects one or two errors (no erasures) in closed form. With Y the
+ * error locators, S_i = sum e Y^(FCR+i), so one error has S_i+1 = Y S_i
+ * and two have S_i+2 = sigma1 S_i+1 + sigma2 S_i, Y1 and Y2 the roots of
+ * x^2 + sigma1 x + sigma2 (Peterson). The recurrence is checked on all
+ * syndromes: if it holds, Berlekamp-Massey would find the same locator,
+ * so the result is the one of the general path. s in index-form.
+ * Returns the count as ao40_decode_rs_8() does, or AO40_RS_FALLBACK. */
+static int ao40_rs_small(uint8_t *data, const uint8_t s[AO40_NROOTS], uint8_t loc[2]) {
+  int i, y;
+
+  if (s[0] != AO40_A0 && s[1] != AO40_A0) {
+    y = AO40_MODNN(s[1] + AO40_NN - s[0]);
+    for (i = 1; i < AO40_NROOTS-1; i++) {
+      if (s[i+1] != AO40_MODNN(s[i] + y))
+        break;
+    }
+    if (i == AO40_NROOTS-1) {
+      loc[0] = (uint8_t)ao40_rs_small_loc(y);
+      if (loc[0] < AO40_PAD)
+        return -1; /* In the padding */
+      /* e = S_0 / Y^FCR */
+      data[loc[0]-AO40_PAD] ^= AO40_ALPHA_TO[AO40_MODNN(s[0] + AO40_NN - AO40_MODNN(AO40_FCR*y))];
+      return 1;
     }
   }
+#if AO40_RS_FAST_T > 1
+  return ao40_rs_small2(data, s, loc);
+#else
+  return AO40_RS_FALLBACK;
+#endif
+}
+#endif
+
+int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
+  return ao40_decode_rs_8_path(data, eras_pos, no_eras, AO40_NULL);
+}
+
+/* ao40_decode_rs_8_path() from the syndromes s of data, in poly-form */
+static int8_t ao40_decode_rs_syn(uint8_t *data, uint8_t s[AO40_NROOTS], int *eras_pos, int no_eras, int *path) {
+  int deg_lambda, el, deg_omega;
+  int i, j, r;
+  uint8_t u,tmp,num1,num2,den,discr_r;
+  uint8_t lambda[AO40_NROOTS+1];        /* Err+Eras Locator poly */
+  uint8_t b[AO40_NROOTS+1], t[AO40_NROOTS+1], omega[AO40_NROOTS+1];
+  uint8_t root[AO40_NROOTS], loc[AO40_NROOTS];
+  int syn_error, count;
+  int rs_path = AO40_RS_PATH_BM;
+#ifdef AO40_GF_MUL_TABLE
+  uint8_t S[AO40_NROOTS];               /* s in poly-form */
+  const uint8_t *row;
+#endif
+#if DEBUG >= 1
+  int k;
+  uint8_t q, reg[AO40_NROOTS+1];
+#endif
 
   /* Convert syndromes to index form, checking for nonzero condition */
   syn_error = 0;
+#ifdef AO40_GF_MUL_TABLE
+  memcpy(S,s,sizeof(S));
+#endif
   for (i=0;i<AO40_NROOTS;i++) {
     syn_error |= s[i];
     s[i] = AO40_INDEX_OF[s[i]];
@@ -109,8 +243,15 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
      * errors to correct. So return data[] unmodified
      */
     count = 0;
+    rs_path = AO40_RS_PATH_CLEAN;
     goto finish;
   }
+#if AO40_RS_FAST_T > 0
+  if (no_eras == 0 && (count = ao40_rs_small(data, s, loc)) != AO40_RS_FALLBACK) {
+    rs_path = AO40_RS_PATH_SMALL;
+    goto finish;
+  }
+#endif
   memset(&lambda[1],0,AO40_NROOTS*sizeof(lambda[0]));
   lambda[0] = 1;
 
@@ -122,7 +263,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
       for (j = i+1; j > 0; j--) {
         tmp = AO40_INDEX_OF[lambda[j - 1]];
         if (tmp != AO40_A0)
-          lambda[j] ^= AO40_ALPHA_TO[AO40_MODNN(u + tmp)];
+          lambda[j] ^= AO40_ALPHA_TO_X[u + tmp];
       }
     }
 
@@ -162,6 +303,40 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
 #endif
 #endif
   }
+#ifdef AO40_GF_MUL_TABLE
+  /*
+   * Berlekamp-Massey as below, all in poly-form: with the products
+   * looked up whole there is nothing to gain from index-form, nor any
+   * zero to test for
+   */
+  memcpy(b,lambda,(AO40_NROOTS+1)*sizeof(b[0]));
+  r = no_eras;
+  el = no_eras;
+  while (++r <= AO40_NROOTS) {        /* r is the step number */
+    discr_r = 0;
+    for (i = 0; i < r; i++)
+      discr_r ^= AO40_GF_MUL[lambda[i]][S[r-i-1]];
+    if (discr_r == 0) {
+      memmove(&b[1],b,AO40_NROOTS*sizeof(b[0]));
+      b[0] = 0;
+    } else {
+      row = AO40_GF_MUL[discr_r];
+      t[0] = lambda[0];
+      for (i = 0 ; i < AO40_NROOTS; i++)
+        t[i+1] = lambda[i+1] ^ row[b[i]];
+      if (2 * el <= r + no_eras - 1) {
+        el = r + no_eras - el;
+        row = AO40_GF_MUL[AO40_GF_INV[discr_r]];
+        for (i = 0; i <= AO40_NROOTS; i++)
+          b[i] = row[lambda[i]];
+      } else {
+        memmove(&b[1],b,AO40_NROOTS*sizeof(b[0]));
+        b[0] = 0;
+      }
+      memcpy(lambda,t,(AO40_NROOTS+1)*sizeof(t[0]));
+    }
+  }
+#else
   for (i=0;i<AO40_NROOTS+1;i++)
     b[i] = AO40_INDEX_OF[lambda[i]];
   
@@ -176,7 +351,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
     discr_r = 0;
     for (i = 0; i < r; i++) {
       if ((lambda[i] != 0) && (s[r-i-1] != AO40_A0)) {
-        discr_r ^= AO40_ALPHA_TO[AO40_MODNN(AO40_INDEX_OF[lambda[i]] + s[r-i-1])];
+        discr_r ^= AO40_ALPHA_TO_X[AO40_INDEX_OF[lambda[i]] + s[r-i-1]];
       }
     }
     discr_r = AO40_INDEX_OF[discr_r];        /* Index form */
@@ -189,7 +364,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
       t[0] = lambda[0];
       for (i = 0 ; i < AO40_NROOTS; i++) {
         if (b[i] != AO40_A0)
-          t[i+1] = lambda[i+1] ^ AO40_ALPHA_TO[AO40_MODNN(discr_r + b[i])];
+          t[i+1] = lambda[i+1] ^ AO40_ALPHA_TO_X[discr_r + b[i]];
         else
           t[i+1] = lambda[i+1];
       }
@@ -209,6 +384,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
       memcpy(lambda,t,(AO40_NROOTS+1)*sizeof(t[0]));
     }
   }
+#endif
 
   /* Convert lambda to index form and compute deg(lambda(x)) */
   deg_lambda = 0;
@@ -218,30 +394,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
       deg_lambda = i;
   }
   /* Find roots of the error+erasure locator polynomial by Chien search */
-  memcpy(&reg[1],&lambda[1],AO40_NROOTS*sizeof(reg[0]));
-  count = 0;                /* Number of roots of lambda(x) */
-  for (i = 1,k=AO40_IPRIM-1; i <= AO40_NN; i++,k = AO40_MODNN(k+AO40_IPRIM)) {
-    q = 1; /* lambda[0] is always 0 */
-    for (j = deg_lambda; j > 0; j--) {
-      if (reg[j] != AO40_A0) {
-        reg[j] = AO40_MODNN(reg[j] + j);
-        q ^= AO40_ALPHA_TO[reg[j]];
-      }
-    }
-    if (q != 0)
-      continue; /* Not a root */
-    /* store root (index-form) and error location number */
-#if DEBUG>=2
-    printf("count %d root %d loc %d\n",count,i,k);
-#endif
-    root[count] = i;
-    loc[count] = k;
-    /* If we've already found max possible roots,
-     * abort the search to save time
-     */
-    if (++count == deg_lambda)
-      break;
-  }
+  count = ao40_active_kernels()->rs_chien(lambda, deg_lambda, root, loc);
   if (deg_lambda != count) {
     /*
      * deg(lambda) unequal to number of roots => uncorrectable
@@ -262,7 +415,7 @@ int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras) {
     tmp = 0;
     for (j=i;j >= 0; j--) {
       if ((s[i - j] != AO40_A0) && (lambda[j] != AO40_A0))
-        tmp ^= AO40_ALPHA_TO[AO40_MODNN(s[i - j] + lambda[j])];
+        tmp ^= AO40_ALPHA_TO_X[s[i - j] + lambda[j]];
     }
     omega[i] = AO40_INDEX_OF[tmp];
   }
@@ -303,6 +456,40 @@ finish:
     for (i=0;i<count;i++)
       eras_pos[i] = loc[i];
   }
+  if (path != AO40_NULL)
+    *path = rs_path;
 
   return count;
 }
+
+int8_t ao40_decode_rs_8_path(uint8_t *data, int *eras_pos, int no_eras, int *path) {
+  uint8_t s[AO40_NROOTS];        /* syndrome poly */
+
+  /* form the syndromes; i.e., evaluate data(x) at roots of g(x) */
+  ao40_active_kernels()->rs_syndrome(data, s);
+  return ao40_decode_rs_syn(data, s, eras_pos, no_eras, path);
+}
+
+void ao40_decode_rs_batch(uint8_t *const data[], int8_t error[], int n) {
+  uint8_t s[AO40_RS_BATCH][AO40_NROOTS];
+  uint8_t syn_error;
+  int lanes, k, i;
+
+  while (n > 0) {
+    if (n >= AO40_RS_BATCH_MIN && ao40_active_kernels()->rs_syndrome_batch != AO40_NULL) {
+      lanes = ao40_active_kernels()->rs_syndrome_batch((const uint8_t *const *)data, n, s);
+    } else {
+      lanes = 1;
+      ao40_active_kernels()->rs_syndrome(data[0], s[0]);
+    }
+    for (k = 0; k < lanes; k++) {
+      syn_error = 0;
+      for (i = 0; i < AO40_NROOTS; i++)
+        syn_error |= s[k][i];
+      error[k] = syn_error ? ao40_decode_rs_syn(data[k], s[k], AO40_NULL, 0, AO40_NULL) : 0;
+    }
+    data += lanes;
+    error += lanes;
+    n -= lanes;
+  }
+}
@@ -3,28 +3,29 @@
 
 #include <stdint.h> // because of uint8_t
 
-#define AO40_NN     255  // GF(2^8-1)
-#define AO40_NROOTS  32
-#define AO40_FCR    112
-#define AO40_PRIM    11
-#define AO40_IPRIM  116
-#define AO40_PAD     95
-
-#include <stdio.h>
-
-extern const uint8_t AO40_ALPHA_TO[];
-extern const uint8_t AO40_INDEX_OF[];
-
-#define AO40_MODNN(x) ao40_mod255(x)
-
-static inline int ao40_mod255(int x){
-  while (x >= 255) {
-    x -= 255;
-    x = (x >> 8) + (x & 255);
-  }
-  return x;
-}
-
-int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pots, int no_eras);
+#include "ao40_gf.h"
+
+#ifndef AO40_RS_FAST_T
+#define AO40_RS_FAST_T 2  // errors solved in closed form without erasures, 0: off
+#endif
+
+void ao40_rs_syndrome_scalar(const uint8_t *data, uint8_t s[AO40_NROOTS]);
+int ao40_rs_chien_scalar(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]);
+
+int8_t ao40_decode_rs_8(uint8_t *data, int *eras_pos, int no_eras);
+
+/* As ao40_decode_rs_8(), and tells in *path which way the word went */
+#define AO40_RS_PATH_CLEAN 0  // zero syndromes
+#define AO40_RS_PATH_SMALL 1  // one or two errors, solved in closed form
+#define AO40_RS_PATH_BM    2  // Berlekamp-Massey, Chien search and Forney
+int8_t ao40_decode_rs_8_path(uint8_t *data, int *eras_pos, int no_eras, int *path);
+
+/* Decodes the n words data[k] in place, error[k] as ao40_decode_rs_8()
+ * without erasures returns. In groups of AO40_RS_BATCH_MIN or more words
+ * the syndromes are formed across words, one per vector lane, and words
+ * with zero syndromes are done right there. */
+#define AO40_RS_BATCH     64  // words per syndrome round, the widest batch kernel
+#define AO40_RS_BATCH_MIN 16  // fewer go one at a time
+void ao40_decode_rs_batch(uint8_t *const data[], int8_t error[], int n);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+/*
+ * SIMD deinterleaver
+ *
+ * The 5200 raw soft bits form a 65 row x 80 column byte matrix that was
+ * written row by row and is read column by column, skipping the first
+ * (sync) column. The kernels transpose 16x16 blocks; the last row and
+ * column blocks overlap the previous ones instead of leaving a remainder.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40_decode_message.h"
+
+#ifdef AO40_X86_KERNELS
+#include <immintrin.h>
+
+/* Store rows rb..rb+15 of column c to their place in conv */
+static inline void ao40_deinterleave_put(uint8_t *conv, int c, int rb, const uint8_t *col) {
+  int j = c * AO40_RAW_ROWS + rb - AO40_RAW_ROWS;
+  int k;
+
+  if (j >= 0 && j + 16 <= AO40_CONV_SIZE) {
+    memcpy(conv + j, col, 16);
+  } else {
+    for (k = 0; k < 16; ++k) {
+      if (j + k >= 0 && j + k < AO40_CONV_SIZE)
+        conv[j + k] = col[k];
+    }
+  }
+}
+
+/* Four rounds of this byte shuffle transpose a 16x16 block */
+#define AO40_TRANSPOSE_ROUND(unpacklo, unpackhi, x, y) \
+  do { \
+    int k_; \
+    for (k_ = 0; k_ < 8; ++k_) { \
+      y[2*k_]   = unpacklo(x[k_], x[k_+8]); \
+      y[2*k_+1] = unpackhi(x[k_], x[k_+8]); \
+    } \
+  } while (0)
+
+AO40_TARGET("sse2")
+void ao40_deinterleave_sse2(const uint8_t *raw, uint8_t *conv) {
+  __m128i x[16], y[16];
+  uint8_t col[16] __attribute__ ((aligned (16)));
+  int r0, c0, rb, cb, k;
+
+  for (r0 = 0; r0 < AO40_RAW_ROWS; r0 += 16) {
+    rb = (r0 + 16 > AO40_RAW_ROWS) ? AO40_RAW_ROWS - 16 : r0;
+    for (c0 = 0; c0 < AO40_RAW_COLS; c0 += 16) {
+      cb = (c0 + 16 > AO40_RAW_COLS) ? AO40_RAW_COLS - 16 : c0;
+      for (k = 0; k < 16; ++k)
+        x[k] = _mm_loadu_si128((const __m128i *)(raw + (rb + k) * AO40_RAW_COLS + cb));
+
+      AO40_TRANSPOSE_ROUND(_mm_unpacklo_epi8, _mm_unpackhi_epi8, x, y);
+      AO40_TRANSPOSE_ROUND(_mm_unpacklo_epi8, _mm_unpackhi_epi8, y, x);
+      AO40_TRANSPOSE_ROUND(_mm_unpacklo_epi8, _mm_unpackhi_epi8, x, y);
+      AO40_TRANSPOSE_ROUND(_mm_unpacklo_epi8, _mm_unpackhi_epi8, y, x);
+
+      for (k = 0; k < 16; ++k) {
+        _mm_store_si128((__m128i *)col, x[k]);
+        ao40_deinterleave_put(conv, cb + k, rb, col);
+      }
+    }
+  }
+}
+
+/* Same as the SSE2 kernel, with two neighbouring blocks per 256-bit row */
+AO40_TARGET("avx2")
+void ao40_deinterleave_avx2(const uint8_t *raw, uint8_t *conv) {
+  __m256i x[16], y[16];
+  uint8_t col[32] __attribute__ ((aligned (32)));
+  int r0, c0, rb, cb, k;
+
+  for (r0 = 0; r0 < AO40_RAW_ROWS; r0 += 16) {
+    rb = (r0 + 16 > AO40_RAW_ROWS) ? AO40_RAW_ROWS - 16 : r0;
+    for (c0 = 0; c0 < AO40_RAW_COLS; c0 += 32) {
+      cb = (c0 + 32 > AO40_RAW_COLS) ? AO40_RAW_COLS - 32 : c0;
+      for (k = 0; k < 16; ++k)
+        x[k] = _mm256_loadu_si256((const __m256i *)(raw + (rb + k) * AO40_RAW_COLS + cb));
+
+      AO40_TRANSPOSE_ROUND(_mm256_unpacklo_epi8, _mm256_unpackhi_epi8, x, y);
+      AO40_TRANSPOSE_ROUND(_mm256_unpacklo_epi8, _mm256_unpackhi_epi8, y, x);
+      AO40_TRANSPOSE_ROUND(_mm256_unpacklo_epi8, _mm256_unpackhi_epi8, x, y);
+      AO40_TRANSPOSE_ROUND(_mm256_unpacklo_epi8, _mm256_unpackhi_epi8, y, x);
+
+      for (k = 0; k < 16; ++k) {
+        _mm256_store_si256((__m256i *)col, x[k]);
+        ao40_deinterleave_put(conv, cb + k, rb, col);
+        ao40_deinterleave_put(conv, cb + 16 + k, rb, col + 16);
+      }
+    }
+  }
+}
+#endif /* AO40_X86_KERNELS */
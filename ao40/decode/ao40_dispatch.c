@@ -0,0 +1,57 @@
+/*
+ * Runtime CPU feature dispatch for the AO-40 decoder kernels
+ */
+
+#include "ao40_dispatch.h"
+
+/* Kernel sets per level: every slot holds the best implementation the
+ * level can run, slots without a dedicated kernel reuse a lower level */
+const struct ao40_kernels ao40_kernel_table[AO40_KERNEL_COUNT] = {
+  { // AO40_KERNEL_SCALAR
+    ao40_update_viterbi_scalar,
+    ao40_update_viterbi_scalar,
+    NULL,
+    ao40_deinterleave_scalar,
+    ao40_rs_syndrome_scalar,
+    NULL,
+    ao40_rs_chien_scalar
+  },
+#ifdef AO40_X86_KERNELS
+  { // AO40_KERNEL_SSE2
+    ao40_update_viterbi_sse2_16,
+    ao40_update_viterbi_sse2_16,
+    ao40_viterbi_batch_sse2,
+    ao40_deinterleave_sse2,
+    ao40_rs_syndrome_scalar,
+    NULL,
+    ao40_rs_chien_scalar
+  },
+  { // AO40_KERNEL_SSSE3
+    ao40_update_viterbi_sse2_16,
+    ao40_update_viterbi_ssse3_8,
+    ao40_viterbi_batch_sse2,
+    ao40_deinterleave_sse2,
+    ao40_rs_syndrome_ssse3,
+    ao40_rs_syndrome_batch_ssse3,
+    ao40_rs_chien_ssse3
+  },
+  { // AO40_KERNEL_AVX2
+    ao40_update_viterbi_avx2_16,
+    ao40_update_viterbi_avx2_8,
+    ao40_viterbi_batch_avx2,
+    ao40_deinterleave_avx2,
+    ao40_rs_syndrome_avx2,
+    ao40_rs_syndrome_batch_avx2,
+    ao40_rs_chien_avx2
+  },
+  { // AO40_KERNEL_AVX512BW
+    ao40_update_viterbi_avx512bw_16,
+    ao40_update_viterbi_avx2_8,
+    ao40_viterbi_batch_avx512bw,
+    ao40_deinterleave_avx2,
+    ao40_rs_syndrome_avx512bw,
+    ao40_rs_syndrome_batch_avx512bw,
+    ao40_rs_chien_avx2
+  },
+#endif
+};
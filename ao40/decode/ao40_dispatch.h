@@ -0,0 +1,62 @@
+#ifndef AO40_DISPATCH_H
+#define AO40_DISPATCH_H
+
+#include <stdint.h>
+#include "ao40_cpu.h"
+#include "ao40_spiral-vit_scalar.h"
+#include "ao40_vit_simd.h"
+#include "ao40_decode_rs.h"
+
+/*
+ * Runtime kernel selection
+ *
+ * One kernel set per CPU feature level of ao40_cpu.h, the active one that
+ * of ao40_get_kernel(): the best for the running CPU unless pinned with the
+ * AO40_KERNEL environment variable or ao40_set_kernel().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct ao40_kernels {
+  void (*update_viterbi)(struct ao40_v *vp, const uint8_t *syms, int nbits);
+  void (*update_viterbi_8)(struct ao40_v *vp, const uint8_t *syms, int nbits);
+  int  (*viterbi_batch)(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40_NUMSTATES]); // NULL: no frame-parallel kernel
+  void (*deinterleave)(const uint8_t *raw, uint8_t *conv);
+  void (*rs_syndrome)(const uint8_t *data, uint8_t s[AO40_NROOTS]);
+  int  (*rs_syndrome_batch)(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]); // NULL: no word-parallel kernel
+  int  (*rs_chien)(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]);
+};
+
+extern const struct ao40_kernels ao40_kernel_table[AO40_KERNEL_COUNT];
+
+/* Active kernel set, never NULL */
+static inline const struct ao40_kernels *ao40_active_kernels(void) {
+  return &ao40_kernel_table[ao40_get_kernel()];
+}
+
+/* Deinterleaver implementations, see ao40_deinterleave() */
+void ao40_deinterleave_scalar(const uint8_t *raw, uint8_t *conv);
+#ifdef AO40_X86_KERNELS
+void ao40_deinterleave_sse2(const uint8_t *raw, uint8_t *conv);
+void ao40_deinterleave_avx2(const uint8_t *raw, uint8_t *conv);
+#endif
+
+/* RS syndrome and Chien search implementations, see ao40_rs_simd.c */
+#ifdef AO40_X86_KERNELS
+void ao40_rs_syndrome_ssse3(const uint8_t *data, uint8_t s[AO40_NROOTS]);
+void ao40_rs_syndrome_avx2(const uint8_t *data, uint8_t s[AO40_NROOTS]);
+void ao40_rs_syndrome_avx512bw(const uint8_t *data, uint8_t s[AO40_NROOTS]);
+int ao40_rs_syndrome_batch_ssse3(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]);
+int ao40_rs_syndrome_batch_avx2(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]);
+int ao40_rs_syndrome_batch_avx512bw(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]);
+int ao40_rs_chien_ssse3(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]);
+int ao40_rs_chien_avx2(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]);
+#endif
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40_DISPATCH_H */
@@ -0,0 +1,435 @@
+/*
+ * SIMD Reed-Solomon syndromes
+ *
+ * Syndrome i is data(x) at b = alpha^((FCR+i)*PRIM), data[0] being the
+ * highest coefficient. The 160 bytes are taken 16 at a time: lane k of
+ * V collects data[16m+k] by Horner's rule in b^16,
+ *
+ *   V = V * b^16 ^ data[16m .. 16m+15]
+ *
+ * and four folds V[k] * b^h ^ V[k+h] (h = 8, 4, 2, 1) leave the syndrome
+ * in lane 0. Every product is by a constant of the root, done by the
+ * nibble-split table lookup (PSHUFB) of
+ *
+ *   c * x = lo_c[x & 15] ^ hi_c[x >> 4]
+ *
+ * PSHUFB looks up within each 128-bit lane with that lane's own table, so
+ * an AVX2 vector works on 2 roots and an AVX-512 vector on 4 at once.
+ *
+ * The Chien search turns this around and keeps one vector per term of
+ * lambda(x): lane m holds lambda_j X^j for 16 (AVX2: 32) consecutive data
+ * positions. Moving on to the next positions multiplies X by a constant,
+ * alpha^(16*PRIM) or alpha^(32*PRIM), so every term is again a product by
+ * a constant, and the lanes whose terms XOR to zero are the roots.
+ *
+ * The batch kernels put one word in every lane instead and run Horner's
+ * rule in b on all of them at once, byte j of every word in one vector.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40_decode_rs.h"
+#include "ao40_dispatch.h"
+
+#ifdef AO40_X86_KERNELS
+#include <immintrin.h>
+
+#define AO40_RS_SYN_LEN    (AO40_NN-AO40_PAD)
+#define AO40_RS_SYN_CHUNKS (AO40_RS_SYN_LEN/16)
+#define AO40_RS_SYN_POWERS 5  // b^16, b^8, b^4, b^2, b
+#define AO40_RS_BATCH_ROOTS 4  // roots a batch kernel works on at once
+
+#if AO40_RS_SYN_LEN % 32
+#error "the SIMD syndromes and Chien search take whole 16 and 32 byte chunks"
+#endif
+
+/* [power][lo, hi][root][x]: the tables of neighbouring roots are adjacent,
+ * so one 32 or 64 byte load gives an AVX2 or AVX-512 vector its roots */
+static uint8_t ao40_rs_syn_tab[AO40_RS_SYN_POWERS][2][AO40_NROOTS][16] __attribute__ ((aligned (64)));
+
+/* Chien search: [j][m] index-form of X^j at data position AO40_PAD+m, and
+ * [16 or 32 positions on][j][lo, hi][x] the tables of the step X^j */
+static uint8_t ao40_rs_chien_log[AO40_NROOTS+1][16];
+static uint8_t ao40_rs_chien_tab[2][AO40_NROOTS+1][2][16] __attribute__ ((aligned (16)));
+
+/* Tables before main(), like the kernel level in ao40_cpu.c */
+__attribute__ ((constructor))
+static void ao40_rs_simd_init(void) {
+  int i, p, x;
+  uint8_t b;
+
+  for (i = 0; i < AO40_NROOTS; ++i) {
+    for (p = 0; p < AO40_RS_SYN_POWERS; ++p) {
+      b = AO40_ALPHA_TO[AO40_MODNN((AO40_FCR+i)*AO40_PRIM * (16 >> p))];
+      for (x = 0; x < 16; ++x) {
+        ao40_rs_syn_tab[p][0][i][x] = ao40_gf_mul((uint8_t)x, b);
+        ao40_rs_syn_tab[p][1][i][x] = ao40_gf_mul((uint8_t)(x << 4), b);
+      }
+    }
+  }
+
+  // position k is X = alpha^((k+1)*PRIM)
+  for (i = 1; i <= AO40_NROOTS; ++i) {
+    for (x = 0; x < 16; ++x)
+      ao40_rs_chien_log[i][x] = (uint8_t)AO40_MODNN(i*(AO40_PAD+1+x)*AO40_PRIM);
+    for (p = 0; p < 2; ++p) {
+      b = AO40_ALPHA_TO[AO40_MODNN(i*(16 << p)*AO40_PRIM)];
+      for (x = 0; x < 16; ++x) {
+        ao40_rs_chien_tab[p][i][0][x] = ao40_gf_mul((uint8_t)x, b);
+        ao40_rs_chien_tab[p][i][1][x] = ao40_gf_mul((uint8_t)(x << 4), b);
+      }
+    }
+  }
+}
+
+/* The nonzero terms of lambda: their exponents j, and lambda_j X^j at the
+ * first 16 positions. Returns how many. */
+static int ao40_rs_chien_terms(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda,
+                               uint8_t j[AO40_NROOTS], uint8_t t[AO40_NROOTS][16]) {
+  int i, m, e, nt = 0;
+
+  for (i = 1; i <= deg_lambda; ++i) {
+    if (lambda[i] == AO40_NN) // A0: a zero term
+      continue;
+    j[nt] = (uint8_t)i;
+    for (m = 0; m < 16; ++m) {
+      e = lambda[i] + ao40_rs_chien_log[i][m];
+      t[nt][m] = AO40_ALPHA_TO[(e >= AO40_NN) ? e - AO40_NN : e];
+    }
+    ++nt;
+  }
+  return nt;
+}
+
+/* Store the roots flagged in mask for the positions from k on, as
+ * ao40_rs_chien_scalar() does. Returns the new count, or -1 once all
+ * deg_lambda roots are found. */
+static int ao40_rs_chien_roots(uint32_t mask, int k, int count, int deg_lambda,
+                               uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]) {
+  int i;
+
+  while (mask != 0) {
+    i = AO40_MODNN((k + __builtin_ctz(mask) + 1)*AO40_PRIM);
+    root[count] = (i == 0) ? AO40_NN : i;
+    loc[count] = (uint8_t)(k + __builtin_ctz(mask));
+    if (++count == deg_lambda)
+      return -1;
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+AO40_TARGET("ssse3")
+static inline __m128i ao40_gf_mul_ssse3(__m128i x, __m128i lo, __m128i hi) {
+  const __m128i mask = _mm_set1_epi8(0x0f);
+
+  return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                       _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+}
+
+AO40_TARGET("ssse3")
+void ao40_rs_syndrome_ssse3(const uint8_t *data, uint8_t s[AO40_NROOTS]) {
+  __m128i chunk[AO40_RS_SYN_CHUNKS], v;
+  int i, m;
+
+  for (m = 0; m < AO40_RS_SYN_CHUNKS; ++m)
+    chunk[m] = _mm_loadu_si128((const __m128i *)(data + 16*m));
+
+  for (i = 0; i < AO40_NROOTS; ++i) {
+    const __m128i lo = _mm_load_si128((const __m128i *)ao40_rs_syn_tab[0][0][i]);
+    const __m128i hi = _mm_load_si128((const __m128i *)ao40_rs_syn_tab[0][1][i]);
+
+    v = chunk[0];
+    for (m = 1; m < AO40_RS_SYN_CHUNKS; ++m)
+      v = _mm_xor_si128(ao40_gf_mul_ssse3(v, lo, hi), chunk[m]);
+
+#define AO40_RS_SYN_FOLD(p, h) \
+    v = _mm_xor_si128(ao40_gf_mul_ssse3(v, _mm_load_si128((const __m128i *)ao40_rs_syn_tab[p][0][i]), \
+                                           _mm_load_si128((const __m128i *)ao40_rs_syn_tab[p][1][i])), \
+                      _mm_srli_si128(v, h))
+    AO40_RS_SYN_FOLD(1, 8);
+    AO40_RS_SYN_FOLD(2, 4);
+    AO40_RS_SYN_FOLD(3, 2);
+    AO40_RS_SYN_FOLD(4, 1);
+#undef AO40_RS_SYN_FOLD
+    s[i] = (uint8_t)_mm_cvtsi128_si32(v);
+  }
+}
+
+AO40_TARGET("avx2")
+static inline __m256i ao40_gf_mul_avx2(__m256i x, __m256i lo, __m256i hi) {
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+
+  return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                          _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask)));
+}
+
+AO40_TARGET("avx2")
+void ao40_rs_syndrome_avx2(const uint8_t *data, uint8_t s[AO40_NROOTS]) {
+  __m256i chunk[AO40_RS_SYN_CHUNKS], v;
+  int i, m;
+
+  for (m = 0; m < AO40_RS_SYN_CHUNKS; ++m)
+    chunk[m] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(data + 16*m)));
+
+  for (i = 0; i < AO40_NROOTS; i += 2) {
+    const __m256i lo = _mm256_load_si256((const __m256i *)ao40_rs_syn_tab[0][0][i]);
+    const __m256i hi = _mm256_load_si256((const __m256i *)ao40_rs_syn_tab[0][1][i]);
+
+    v = chunk[0];
+    for (m = 1; m < AO40_RS_SYN_CHUNKS; ++m)
+      v = _mm256_xor_si256(ao40_gf_mul_avx2(v, lo, hi), chunk[m]);
+
+#define AO40_RS_SYN_FOLD(p, h) \
+    v = _mm256_xor_si256(ao40_gf_mul_avx2(v, _mm256_load_si256((const __m256i *)ao40_rs_syn_tab[p][0][i]), \
+                                             _mm256_load_si256((const __m256i *)ao40_rs_syn_tab[p][1][i])), \
+                         _mm256_srli_si256(v, h))
+    AO40_RS_SYN_FOLD(1, 8);
+    AO40_RS_SYN_FOLD(2, 4);
+    AO40_RS_SYN_FOLD(3, 2);
+    AO40_RS_SYN_FOLD(4, 1);
+#undef AO40_RS_SYN_FOLD
+    s[i] = (uint8_t)_mm256_extract_epi8(v, 0);
+    s[i+1] = (uint8_t)_mm256_extract_epi8(v, 16);
+  }
+}
+
+AO40_TARGET("avx512bw")
+static inline __m512i ao40_gf_mul_avx512bw(__m512i x, __m512i lo, __m512i hi) {
+  const __m512i mask = _mm512_set1_epi8(0x0f);
+
+  return _mm512_xor_si512(_mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+                          _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi16(x, 4), mask)));
+}
+
+AO40_TARGET("avx512bw")
+void ao40_rs_syndrome_avx512bw(const uint8_t *data, uint8_t s[AO40_NROOTS]) {
+  __m512i chunk[AO40_RS_SYN_CHUNKS], v;
+  uint8_t out[64] __attribute__ ((aligned (64)));
+  int i, m;
+
+  for (m = 0; m < AO40_RS_SYN_CHUNKS; ++m)
+    chunk[m] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(data + 16*m)));
+
+  for (i = 0; i < AO40_NROOTS; i += 4) {
+    const __m512i lo = _mm512_load_si512((const void *)ao40_rs_syn_tab[0][0][i]);
+    const __m512i hi = _mm512_load_si512((const void *)ao40_rs_syn_tab[0][1][i]);
+
+    v = chunk[0];
+    for (m = 1; m < AO40_RS_SYN_CHUNKS; ++m)
+      v = _mm512_xor_si512(ao40_gf_mul_avx512bw(v, lo, hi), chunk[m]);
+
+#define AO40_RS_SYN_FOLD(p, h) \
+    v = _mm512_xor_si512(ao40_gf_mul_avx512bw(v, _mm512_load_si512((const void *)ao40_rs_syn_tab[p][0][i]), \
+                                                 _mm512_load_si512((const void *)ao40_rs_syn_tab[p][1][i])), \
+                         _mm512_bsrli_epi128(v, h))
+    AO40_RS_SYN_FOLD(1, 8);
+    AO40_RS_SYN_FOLD(2, 4);
+    AO40_RS_SYN_FOLD(3, 2);
+    AO40_RS_SYN_FOLD(4, 1);
+#undef AO40_RS_SYN_FOLD
+    _mm512_store_si512((void *)out, v);
+    s[i] = out[0];
+    s[i+1] = out[16];
+    s[i+2] = out[32];
+    s[i+3] = out[48];
+  }
+}
+
+/* Byte j of word l to col[j*width + l], the unused lanes zero. Blocks of
+ * 16 words by 16 bytes are transposed in registers: four rounds of
+ * interleaving row i with row i+8 bring byte j of row i to row j. */
+AO40_TARGET("sse2")
+static void ao40_rs_batch_columns(const uint8_t *const data[], int lanes, int width, uint8_t *col) {
+  static const uint8_t zero[AO40_RS_SYN_LEN];
+  const uint8_t *row[16];
+  __m128i a[16], b[16];
+  int l, j, i, r;
+
+  for (l = 0; l < width; l += 16) {
+    for (i = 0; i < 16; ++i)
+      row[i] = (l+i < lanes) ? data[l+i] : zero;
+    for (j = 0; j < AO40_RS_SYN_LEN; j += 16) {
+      for (i = 0; i < 16; ++i)
+        a[i] = _mm_loadu_si128((const __m128i *)(row[i] + j));
+      for (r = 0; r < 4; ++r) {
+        for (i = 0; i < 8; ++i) {
+          b[2*i] = _mm_unpacklo_epi8(a[i], a[i+8]);
+          b[2*i+1] = _mm_unpackhi_epi8(a[i], a[i+8]);
+        }
+        memcpy(a, b, sizeof(a));
+      }
+      for (i = 0; i < 16; ++i)
+        _mm_store_si128((__m128i *)(col + (j+i)*width + l), a[i]);
+    }
+  }
+}
+
+AO40_TARGET("ssse3")
+int ao40_rs_syndrome_batch_ssse3(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]) {
+  uint8_t col[AO40_RS_SYN_LEN][16] __attribute__ ((aligned (16)));
+  uint8_t out[16] __attribute__ ((aligned (16)));
+  int lanes = (n < 16) ? n : 16;
+  int i, j, l, r;
+
+  ao40_rs_batch_columns(data, lanes, 16, col[0]);
+  for (i = 0; i < AO40_NROOTS; i += AO40_RS_BATCH_ROOTS) {
+    __m128i v[AO40_RS_BATCH_ROOTS], lo[AO40_RS_BATCH_ROOTS], hi[AO40_RS_BATCH_ROOTS];
+
+    // independent roots side by side, one alone would wait on each product
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      lo[r] = _mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][0][i+r]);
+      hi[r] = _mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][1][i+r]);
+      v[r] = _mm_load_si128((const __m128i *)col[0]);
+    }
+    for (j = 1; j < AO40_RS_SYN_LEN; ++j) {
+      const __m128i c = _mm_load_si128((const __m128i *)col[j]);
+
+#pragma GCC unroll 4
+      for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r)
+        v[r] = _mm_xor_si128(ao40_gf_mul_ssse3(v[r], lo[r], hi[r]), c);
+    }
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      _mm_store_si128((__m128i *)out, v[r]);
+      for (l = 0; l < lanes; ++l)
+        s[l][i+r] = out[l];
+    }
+  }
+  return lanes;
+}
+
+AO40_TARGET("avx2")
+int ao40_rs_syndrome_batch_avx2(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]) {
+  uint8_t col[AO40_RS_SYN_LEN][32] __attribute__ ((aligned (32)));
+  uint8_t out[32] __attribute__ ((aligned (32)));
+  const int lanes = 32;
+  int i, j, l, r;
+
+  // a part filled vector costs as much as a full one
+  if (n < lanes)
+    return ao40_rs_syndrome_batch_ssse3(data, n, s);
+  ao40_rs_batch_columns(data, lanes, 32, col[0]);
+  for (i = 0; i < AO40_NROOTS; i += AO40_RS_BATCH_ROOTS) {
+    __m256i v[AO40_RS_BATCH_ROOTS], lo[AO40_RS_BATCH_ROOTS], hi[AO40_RS_BATCH_ROOTS];
+
+    // independent roots side by side, one alone would wait on each product
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      lo[r] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][0][i+r]));
+      hi[r] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][1][i+r]));
+      v[r] = _mm256_load_si256((const __m256i *)col[0]);
+    }
+    for (j = 1; j < AO40_RS_SYN_LEN; ++j) {
+      const __m256i c = _mm256_load_si256((const __m256i *)col[j]);
+
+#pragma GCC unroll 4
+      for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r)
+        v[r] = _mm256_xor_si256(ao40_gf_mul_avx2(v[r], lo[r], hi[r]), c);
+    }
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      _mm256_store_si256((__m256i *)out, v[r]);
+      for (l = 0; l < lanes; ++l)
+        s[l][i+r] = out[l];
+    }
+  }
+  return lanes;
+}
+
+AO40_TARGET("avx512bw")
+int ao40_rs_syndrome_batch_avx512bw(const uint8_t *const data[], int n, uint8_t (*s)[AO40_NROOTS]) {
+  uint8_t col[AO40_RS_SYN_LEN][64] __attribute__ ((aligned (64)));
+  uint8_t out[64] __attribute__ ((aligned (64)));
+  const int lanes = 64;
+  int i, j, l, r;
+
+  // a part filled vector costs as much as a full one
+  if (n < lanes)
+    return ao40_rs_syndrome_batch_avx2(data, n, s);
+  ao40_rs_batch_columns(data, lanes, 64, col[0]);
+  for (i = 0; i < AO40_NROOTS; i += AO40_RS_BATCH_ROOTS) {
+    __m512i v[AO40_RS_BATCH_ROOTS], lo[AO40_RS_BATCH_ROOTS], hi[AO40_RS_BATCH_ROOTS];
+
+    // independent roots side by side, one alone would wait on each product
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      lo[r] = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][0][i+r]));
+      hi[r] = _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)ao40_rs_syn_tab[AO40_RS_SYN_POWERS-1][1][i+r]));
+      v[r] = _mm512_load_si512((const void *)col[0]);
+    }
+    for (j = 1; j < AO40_RS_SYN_LEN; ++j) {
+      const __m512i c = _mm512_load_si512((const void *)col[j]);
+
+#pragma GCC unroll 4
+      for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r)
+        v[r] = _mm512_xor_si512(ao40_gf_mul_avx512bw(v[r], lo[r], hi[r]), c);
+    }
+    for (r = 0; r < AO40_RS_BATCH_ROOTS; ++r) {
+      _mm512_store_si512((void *)out, v[r]);
+      for (l = 0; l < lanes; ++l)
+        s[l][i+r] = out[l];
+    }
+  }
+  return lanes;
+}
+
+AO40_TARGET("ssse3")
+int ao40_rs_chien_ssse3(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]) {
+  uint8_t j[AO40_NROOTS];
+  uint8_t t[AO40_NROOTS][16] __attribute__ ((aligned (16)));
+  __m128i T[AO40_NROOTS], q;
+  int n, nt, k, count = 0;
+
+  nt = ao40_rs_chien_terms(lambda, deg_lambda, j, t);
+  for (n = 0; n < nt; ++n)
+    T[n] = _mm_load_si128((const __m128i *)t[n]);
+
+  for (k = AO40_PAD; k < AO40_NN; k += 16) {
+    if (count + (AO40_NN - k) < deg_lambda)
+      break; /* Too few positions left */
+    q = _mm_set1_epi8(1); /* lambda[0] is always 0 */
+    for (n = 0; n < nt; ++n) {
+      q = _mm_xor_si128(q, T[n]);
+      T[n] = ao40_gf_mul_ssse3(T[n], _mm_load_si128((const __m128i *)ao40_rs_chien_tab[0][j[n]][0]),
+                                     _mm_load_si128((const __m128i *)ao40_rs_chien_tab[0][j[n]][1]));
+    }
+    count = ao40_rs_chien_roots((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(q, _mm_setzero_si128())),
+                                k, count, deg_lambda, root, loc);
+    if (count < 0)
+      return deg_lambda;
+  }
+  return count;
+}
+
+/* Also the AVX-512 one: the 160 positions are not a multiple of 64 */
+AO40_TARGET("avx2")
+int ao40_rs_chien_avx2(const uint8_t lambda[AO40_NROOTS+1], int deg_lambda, uint8_t root[AO40_NROOTS], uint8_t loc[AO40_NROOTS]) {
+  uint8_t j[AO40_NROOTS];
+  uint8_t t[AO40_NROOTS][16] __attribute__ ((aligned (16)));
+  __m256i T[AO40_NROOTS], q;
+  __m128i lo;
+  int n, nt, k, count = 0;
+
+  // the upper 16 positions are the lower ones 16 positions on
+  nt = ao40_rs_chien_terms(lambda, deg_lambda, j, t);
+  for (n = 0; n < nt; ++n) {
+    lo = _mm_load_si128((const __m128i *)t[n]);
+    T[n] = _mm256_set_m128i(ao40_gf_mul_ssse3(lo, _mm_load_si128((const __m128i *)ao40_rs_chien_tab[0][j[n]][0]),
+                                                  _mm_load_si128((const __m128i *)ao40_rs_chien_tab[0][j[n]][1])), lo);
+  }
+
+  for (k = AO40_PAD; k < AO40_NN; k += 32) {
+    if (count + (AO40_NN - k) < deg_lambda)
+      break; /* Too few positions left */
+    q = _mm256_set1_epi8(1); /* lambda[0] is always 0 */
+    for (n = 0; n < nt; ++n) {
+      q = _mm256_xor_si256(q, T[n]);
+      T[n] = ao40_gf_mul_avx2(T[n], _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_rs_chien_tab[1][j[n]][0])),
+                                    _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_rs_chien_tab[1][j[n]][1])));
+    }
+    count = ao40_rs_chien_roots((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(q, _mm256_setzero_si256())),
+                                k, count, deg_lambda, root, loc);
+    if (count < 0)
+      return deg_lambda;
+  }
+  return count;
+}
+
+#endif
@@ -48,9 +48,11 @@ struct ao40_v {
   __attribute__ ((aligned (16))) ao40_metric_t metrics2; /* path metric buffer 2 */
   ao40_metric_t *old_metrics,*new_metrics; /* Pointers to path metrics, swapped on every bit */
   ao40_decision_t *decisions;   /* decisions */
+  const AO40_COMPUTETYPE *branchtab; /* ao40_Branchtab, or ao40_Branchtab_s8 for int8 symbols */
 };
 
 extern AO40_COMPUTETYPE ao40_Branchtab[AO40_NUMSTATES/2*AO40_RATE] __attribute__ ((aligned (16)));
+extern const AO40_COMPUTETYPE ao40_Branchtab_s8[AO40_NUMSTATES/2*AO40_RATE] __attribute__ ((aligned (16)));
 
 static const uint8_t ao40_Partab[256] = {
   0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00, 
@@ -82,6 +84,7 @@ int ao40_init_viterbi(void *p, int starting_state);
 void *ao40_create_viterbi(int len);
 int ao40_chainback_viterbi(void *p, uint8_t *data, uint32_t nbits, uint32_t endstate);
 void ao40_delete_viterbi(void *p);
-int ao40_update_viterbi_blk(void *p, AO40_COMPUTETYPE *syms, int nbits);
+int ao40_update_viterbi_blk(void *p, const uint8_t *syms, int nbits);
+int ao40_update_viterbi_blk_8(void *p, const uint8_t *syms, int nbits);
 
 #endif /* AO40_SPIRAL_VIT_SCALAR_H */
@@ -0,0 +1,118 @@
+/*
+ * Serial list Viterbi: single-divergence alternatives of a decoded frame
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "ao40_vit_list.h"
+
+#define AO40_LIST_ADDSHIFT (8-(AO40_K-1))
+
+/* Insert (row, cost) into the sorted list, dropping the worst if full */
+static void ao40_list_insert(struct ao40_list *l, int nalt, int row, uint32_t cost) {
+  int i;
+
+  if (l->n == nalt && cost >= l->cost[l->n-1])
+    return;
+  i = (l->n < nalt) ? l->n++ : l->n-1;
+  for (; i > 0 && l->cost[i-1] > cost; --i) {
+    l->row[i] = l->row[i-1];
+    l->cost[i] = l->cost[i-1];
+  }
+  l->row[i] = (uint16_t)row;
+  l->cost[i] = cost;
+}
+
+/* One trellis step of 16-bit metrics modulo 2^16, as in the SIMD kernels:
+ * the spread of the metrics stays far below 2^15, so differences taken
+ * as int16_t are exact */
+static inline void ao40_list_step(const uint16_t *restrict X, uint16_t *restrict Y, uint16_t s0, uint16_t s1,
+                                  const uint16_t *restrict bt0, const uint16_t *restrict bt1) {
+  uint16_t t, m0, m1, m2, m3;
+  int i;
+
+  for (i = 0; i < AO40_NUMSTATES/2; ++i) {
+    t = (uint16_t)((s0^bt0[i]) + (s1^bt1[i]));
+    m0 = X[i] + t;
+    m1 = X[i+AO40_NUMSTATES/2] + (510 - t);
+    m2 = X[i] + (510 - t);
+    m3 = X[i+AO40_NUMSTATES/2] + t;
+    Y[2*i] = ((int16_t)(m0 - m1) > 0) ? m1 : m0;
+    Y[2*i+1] = ((int16_t)(m2 - m3) > 0) ? m3 : m2;
+  }
+}
+
+void ao40_list_gaps(const struct ao40_v *vp, const uint8_t *syms, uint8_t state[AO40_LIST_ROWS], uint32_t gap[AO40_LIST_ROWS]) {
+  __attribute__ ((aligned (16))) uint16_t a[AO40_NUMSTATES], b[AO40_NUMSTATES];
+  uint16_t bt0[AO40_NUMSTATES/2], bt1[AO40_NUMSTATES/2];
+  uint16_t *X = a, *Y = b, *tmp;
+  uint16_t t, m0, m1;
+  uint32_t endstate = 0;
+  int r, i;
+
+  // best path: the state whose decision the chainback reads on every row
+  for (r = AO40_LIST_ROWS-1; r >= 0; --r) {
+    state[r] = (uint8_t)(endstate >> AO40_LIST_ADDSHIFT);
+    endstate = (endstate >> 1) | ((uint32_t)ao40_list_bit(vp, r, state[r]) << (AO40_K-2+AO40_LIST_ADDSHIFT));
+  }
+
+  // forward pass with the metrics of ao40_init_viterbi(vp, 0): the cost of
+  // leaving the best path at row r is the gap between the two paths into
+  // its node there. The first K-1 rows have no valid second path.
+  for (i = 0; i < AO40_NUMSTATES/2; ++i) {
+    bt0[i] = (uint16_t)vp->branchtab[i];
+    bt1[i] = (uint16_t)vp->branchtab[AO40_NUMSTATES/2+i];
+  }
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    X[i] = 63;
+  X[0] = 0;
+  for (r = 0; r < AO40_LIST_ROWS; ++r) {
+    if (r >= AO40_K-1) {
+      i = state[r] >> 1;
+      t = (uint16_t)((syms[2*r]^bt0[i]) + (syms[2*r+1]^bt1[i]));
+      // even states compare X[i]+t with X[i+AO40_NUMSTATES/2]+(510-t), odd ones the other way
+      if (state[r] & 1)
+        t = 510 - t;
+      m0 = X[i] + t;
+      m1 = X[i+AO40_NUMSTATES/2] + (510 - t);
+      gap[r] = (uint32_t)abs((int16_t)(m0 - m1));
+    } else {
+      gap[r] = UINT32_MAX;
+    }
+    ao40_list_step(X, Y, syms[2*r], syms[2*r+1], bt0, bt1);
+    tmp = X;
+    X = Y;
+    Y = tmp;
+  }
+}
+
+int ao40_list_init(struct ao40_list *l, const struct ao40_v *vp, const uint8_t *syms, int nalt) {
+  uint32_t gap[AO40_LIST_ROWS];
+  int r;
+
+  l->n = 0;
+  if (nalt > AO40_LIST_MAX)
+    nalt = AO40_LIST_MAX;
+  if (nalt <= 0)
+    return 0;
+
+  ao40_list_gaps(vp, syms, l->state, gap);
+  for (r = AO40_K-1; r < AO40_LIST_ROWS; ++r)
+    ao40_list_insert(l, nalt, r, gap[r]);
+  return l->n;
+}
+
+void ao40_list_chainback(const struct ao40_list *l, const struct ao40_v *vp, int k, uint8_t *data) {
+  uint32_t nbits = AO40_FRAMEBITS;
+  uint32_t endstate = 0;
+  uint32_t row = l->row[k];
+  uint32_t d;
+
+  while (nbits-- != 0) {
+    d = (uint32_t)ao40_list_bit(vp, nbits + (AO40_K-1), endstate >> AO40_LIST_ADDSHIFT);
+    if (nbits + (AO40_K-1) == row)
+      d ^= 1;
+    endstate = (endstate >> 1) | (d << (AO40_K-2+AO40_LIST_ADDSHIFT));
+    data[nbits>>3] = (uint8_t)endstate;
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef AO40_VIT_LIST_H
+#define AO40_VIT_LIST_H
+
+#include <stdint.h>
+#include "ao40_spiral-vit_scalar.h"
+
+/*
+ * List Viterbi on top of a decoded frame.
+ *
+ * Every node of the best path had a second, discarded path merging into
+ * it. Taking that branch instead costs exactly the metric difference of
+ * the two, so the alternatives ordered by that difference are the best
+ * paths that leave the best one once. The 2nd best path of the whole
+ * trellis is always among them, but from the 3rd on this is only an
+ * approximation of the true L best list: paths that leave the best one
+ * more than once are never produced.
+ *
+ * ao40_list_init() recomputes the metrics along the best path (a scalar
+ * pass, meant for frames that already failed), ao40_list_chainback()
+ * writes the candidates in order of increasing path metric.
+ */
+
+#define AO40_LIST_MAX  64  // alternatives kept
+#define AO40_LIST_ROWS (AO40_FRAMEBITS+(AO40_K-1))
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct ao40_list {
+  uint8_t state[AO40_LIST_ROWS];  // best path state per row
+  uint16_t row[AO40_LIST_MAX];    // divergence rows, best first
+  uint32_t cost[AO40_LIST_MAX];   // metric above the best path
+  int n;
+};
+
+static inline int ao40_list_bit(const struct ao40_v *vp, int row, int state) {
+  return (vp->decisions[row].w[state/32] >> (state%32)) & 1;
+}
+
+/* Walks the best path of vp (decoded from state 0 to state 0 with exact
+ * metrics) and writes its state on every row and the metric gap to the
+ * other path merging into it there, UINT32_MAX on the first K-1 rows. */
+void ao40_list_gaps(const struct ao40_v *vp, const uint8_t *syms, uint8_t state[AO40_LIST_ROWS], uint32_t gap[AO40_LIST_ROWS]);
+
+/* vp holds the decisions of syms for the whole frame, decoded from state 0
+ * to state 0 (ao40_init_viterbi(vp, 0), exact metrics). Keeps at most
+ * nalt alternatives and returns how many there are. */
+int ao40_list_init(struct ao40_list *l, const struct ao40_v *vp, const uint8_t *syms, int nalt);
+
+/* Writes alternative k (0: the best of them) of AO40_FRAMEBITS bits */
+void ao40_list_chainback(const struct ao40_list *l, const struct ao40_v *vp, int k, uint8_t *data);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40_VIT_LIST_H */
@@ -0,0 +1,332 @@
+/*
+ * SIMD Viterbi kernels for the AO-40 K=7 r=1/2 convolutional code
+ *
+ * State layout follows ao40_vit_step(): butterfly i combines old states
+ * i and i+AO40_NUMSTATES/2 into new states 2i and 2i+1, decision bit n of a step belongs
+ * to new state n.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40_vit_simd.h"
+
+#ifdef AO40_X86_KERNELS
+#include <immintrin.h>
+
+/* Wrapping 16-bit metrics: only their differences are meaningful */
+static void ao40_load_metrics_16(const struct ao40_v *vp, uint16_t m[AO40_NUMSTATES]) {
+  int i;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    m[i] = (uint16_t)vp->old_metrics->t[i];
+}
+
+static void ao40_store_metrics_16(struct ao40_v *vp, const uint16_t m[AO40_NUMSTATES]) {
+  int i;
+  int16_t min = 0;
+
+  for (i = 1; i < AO40_NUMSTATES; ++i) {
+    if ((int16_t)(m[i] - m[0]) < min)
+      min = (int16_t)(m[i] - m[0]);
+  }
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    vp->old_metrics->t[i] = (AO40_COMPUTETYPE)((int16_t)(m[i] - m[0]) - min);
+}
+
+/* 8-bit metrics are the scalar ones scaled down by 8 */
+static void ao40_load_metrics_8(const struct ao40_v *vp, uint8_t m[AO40_NUMSTATES]) {
+  AO40_COMPUTETYPE min = vp->old_metrics->t[0];
+  AO40_COMPUTETYPE x;
+  int i;
+
+  for (i = 1; i < AO40_NUMSTATES; ++i) {
+    if (vp->old_metrics->t[i] < min)
+      min = vp->old_metrics->t[i];
+  }
+  for (i = 0; i < AO40_NUMSTATES; ++i) {
+    x = (vp->old_metrics->t[i] - min) >> 3;
+    m[i] = (x > 255) ? 255 : (uint8_t)x;
+  }
+}
+
+static void ao40_store_metrics_8(struct ao40_v *vp, const uint8_t m[AO40_NUMSTATES]) {
+  int i;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    vp->old_metrics->t[i] = (AO40_COMPUTETYPE)m[i] << 3;
+}
+
+AO40_TARGET("sse2")
+void ao40_update_viterbi_sse2_16(struct ao40_v *vp, const uint8_t *syms, int nbits) {
+  uint16_t tmp[AO40_NUMSTATES] __attribute__ ((aligned (16)));
+  __m128i m[8], n[8], bt0[4], bt1[4];
+  const __m128i full = _mm_set1_epi16(510);
+  const __m128i zero = _mm_setzero_si128();
+  int i, g, s;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    tmp[i] = (uint16_t)vp->branchtab[i];
+  for (g = 0; g < 4; ++g) {
+    bt0[g] = _mm_load_si128((const __m128i *)&tmp[8*g]);
+    bt1[g] = _mm_load_si128((const __m128i *)&tmp[AO40_NUMSTATES/2 + 8*g]);
+  }
+
+  ao40_load_metrics_16(vp, tmp);
+  for (i = 0; i < 8; ++i)
+    m[i] = _mm_load_si128((const __m128i *)&tmp[8*i]);
+
+  for (s = 0; s < nbits; ++s) {
+    __m128i sym0 = _mm_set1_epi16((short)syms[2*s]);
+    __m128i sym1 = _mm_set1_epi16((short)syms[2*s+1]);
+
+    for (g = 0; g < 4; ++g) {
+      __m128i t  = _mm_add_epi16(_mm_xor_si128(sym0, bt0[g]), _mm_xor_si128(sym1, bt1[g]));
+      __m128i tc = _mm_sub_epi16(full, t);
+      __m128i m0 = _mm_add_epi16(m[g], t);
+      __m128i m1 = _mm_add_epi16(m[g+4], tc);
+      __m128i m2 = _mm_add_epi16(m[g], tc);
+      __m128i m3 = _mm_add_epi16(m[g+4], t);
+      __m128i d0 = _mm_cmpgt_epi16(_mm_sub_epi16(m0, m1), zero);
+      __m128i d1 = _mm_cmpgt_epi16(_mm_sub_epi16(m2, m3), zero);
+      __m128i s0 = _mm_or_si128(_mm_and_si128(d0, m1), _mm_andnot_si128(d0, m0));
+      __m128i s1 = _mm_or_si128(_mm_and_si128(d1, m3), _mm_andnot_si128(d1, m2));
+
+      n[2*g]   = _mm_unpacklo_epi16(s0, s1);
+      n[2*g+1] = _mm_unpackhi_epi16(s0, s1);
+      vp->decisions[s].s[g] = (unsigned short)_mm_movemask_epi8(
+          _mm_packs_epi16(_mm_unpacklo_epi16(d0, d1), _mm_unpackhi_epi16(d0, d1)));
+    }
+    for (i = 0; i < 8; ++i)
+      m[i] = n[i];
+  }
+
+  for (i = 0; i < 8; ++i)
+    _mm_store_si128((__m128i *)&tmp[8*i], m[i]);
+  ao40_store_metrics_16(vp, tmp);
+}
+
+AO40_TARGET("ssse3")
+void ao40_update_viterbi_ssse3_8(struct ao40_v *vp, const uint8_t *syms, int nbits) {
+  uint8_t tmp[AO40_NUMSTATES] __attribute__ ((aligned (16)));
+  __m128i m[4], n[4], bt0[2], bt1[2], min;
+  const __m128i max_bm = _mm_set1_epi8(63);
+  const __m128i zero = _mm_setzero_si128();
+  int i, g, s;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    tmp[i] = (uint8_t)vp->branchtab[i];
+  for (g = 0; g < 2; ++g) {
+    bt0[g] = _mm_load_si128((const __m128i *)&tmp[16*g]);
+    bt1[g] = _mm_load_si128((const __m128i *)&tmp[AO40_NUMSTATES/2 + 16*g]);
+  }
+
+  ao40_load_metrics_8(vp, tmp);
+  for (i = 0; i < 4; ++i)
+    m[i] = _mm_load_si128((const __m128i *)&tmp[16*i]);
+
+  for (s = 0; s < nbits; ++s) {
+    __m128i sym0 = _mm_set1_epi8((char)syms[2*s]);
+    __m128i sym1 = _mm_set1_epi8((char)syms[2*s+1]);
+
+    for (g = 0; g < 2; ++g) {
+      __m128i t  = _mm_avg_epu8(_mm_xor_si128(sym0, bt0[g]), _mm_xor_si128(sym1, bt1[g]));
+      __m128i tc, m0, m1, m2, m3, s0, s1, d0, d1;
+
+      t  = _mm_and_si128(_mm_srli_epi16(t, 2), max_bm);
+      tc = _mm_sub_epi8(max_bm, t);
+      m0 = _mm_adds_epu8(m[g], t);
+      m1 = _mm_adds_epu8(m[g+2], tc);
+      m2 = _mm_adds_epu8(m[g], tc);
+      m3 = _mm_adds_epu8(m[g+2], t);
+      s0 = _mm_min_epu8(m0, m1);
+      s1 = _mm_min_epu8(m2, m3);
+      /* inverted decisions: set where the upper branch survived */
+      d0 = _mm_cmpeq_epi8(s0, m0);
+      d1 = _mm_cmpeq_epi8(s1, m2);
+
+      n[2*g]   = _mm_unpacklo_epi8(s0, s1);
+      n[2*g+1] = _mm_unpackhi_epi8(s0, s1);
+      vp->decisions[s].s[2*g]   = (unsigned short)~_mm_movemask_epi8(_mm_unpacklo_epi8(d0, d1));
+      vp->decisions[s].s[2*g+1] = (unsigned short)~_mm_movemask_epi8(_mm_unpackhi_epi8(d0, d1));
+    }
+
+    /* Renormalize: subtract the smallest metric from every state */
+    min = _mm_min_epu8(_mm_min_epu8(n[0], n[1]), _mm_min_epu8(n[2], n[3]));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 8));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 4));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 2));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 1));
+    min = _mm_shuffle_epi8(min, zero);
+    for (i = 0; i < 4; ++i)
+      m[i] = _mm_subs_epu8(n[i], min);
+  }
+
+  for (i = 0; i < 4; ++i)
+    _mm_store_si128((__m128i *)&tmp[16*i], m[i]);
+  ao40_store_metrics_8(vp, tmp);
+}
+
+AO40_TARGET("avx2")
+void ao40_update_viterbi_avx2_16(struct ao40_v *vp, const uint8_t *syms, int nbits) {
+  uint16_t tmp[AO40_NUMSTATES] __attribute__ ((aligned (32)));
+  __m256i m[4], n[4], bt0[2], bt1[2];
+  const __m256i full = _mm256_set1_epi16(510);
+  const __m256i zero = _mm256_setzero_si256();
+  int i, g, s;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    tmp[i] = (uint16_t)vp->branchtab[i];
+  for (g = 0; g < 2; ++g) {
+    bt0[g] = _mm256_load_si256((const __m256i *)&tmp[16*g]);
+    bt1[g] = _mm256_load_si256((const __m256i *)&tmp[AO40_NUMSTATES/2 + 16*g]);
+  }
+
+  ao40_load_metrics_16(vp, tmp);
+  for (i = 0; i < 4; ++i)
+    m[i] = _mm256_load_si256((const __m256i *)&tmp[16*i]);
+
+  for (s = 0; s < nbits; ++s) {
+    __m256i sym0 = _mm256_set1_epi16((short)syms[2*s]);
+    __m256i sym1 = _mm256_set1_epi16((short)syms[2*s+1]);
+
+    for (g = 0; g < 2; ++g) {
+      __m256i t  = _mm256_add_epi16(_mm256_xor_si256(sym0, bt0[g]), _mm256_xor_si256(sym1, bt1[g]));
+      __m256i tc = _mm256_sub_epi16(full, t);
+      __m256i m0 = _mm256_add_epi16(m[g], t);
+      __m256i m1 = _mm256_add_epi16(m[g+2], tc);
+      __m256i m2 = _mm256_add_epi16(m[g], tc);
+      __m256i m3 = _mm256_add_epi16(m[g+2], t);
+      __m256i d0 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m0, m1), zero);
+      __m256i d1 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m2, m3), zero);
+      __m256i s0 = _mm256_blendv_epi8(m0, m1, d0);
+      __m256i s1 = _mm256_blendv_epi8(m2, m3, d1);
+      /* unpack works per 128-bit lane: lo = states 0-7|16-23, hi = 8-15|24-31 */
+      __m256i lo = _mm256_unpacklo_epi16(s0, s1);
+      __m256i hi = _mm256_unpackhi_epi16(s0, s1);
+
+      n[2*g]   = _mm256_permute2x128_si256(lo, hi, 0x20);
+      n[2*g+1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+      vp->decisions[s].w[g] = (uint32_t)_mm256_movemask_epi8(
+          _mm256_packs_epi16(_mm256_unpacklo_epi16(d0, d1), _mm256_unpackhi_epi16(d0, d1)));
+    }
+    for (i = 0; i < 4; ++i)
+      m[i] = n[i];
+  }
+
+  for (i = 0; i < 4; ++i)
+    _mm256_store_si256((__m256i *)&tmp[16*i], m[i]);
+  ao40_store_metrics_16(vp, tmp);
+}
+
+AO40_TARGET("avx2")
+void ao40_update_viterbi_avx2_8(struct ao40_v *vp, const uint8_t *syms, int nbits) {
+  uint8_t tmp[AO40_NUMSTATES] __attribute__ ((aligned (32)));
+  __m256i m[2], bt0, bt1;
+  __m128i min;
+  const __m256i max_bm = _mm256_set1_epi8(63);
+  int i, s;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    tmp[i] = (uint8_t)vp->branchtab[i];
+  bt0 = _mm256_load_si256((const __m256i *)&tmp[0]);
+  bt1 = _mm256_load_si256((const __m256i *)&tmp[AO40_NUMSTATES/2]);
+
+  ao40_load_metrics_8(vp, tmp);
+  m[0] = _mm256_load_si256((const __m256i *)&tmp[0]);
+  m[1] = _mm256_load_si256((const __m256i *)&tmp[32]);
+
+  for (s = 0; s < nbits; ++s) {
+    __m256i sym0 = _mm256_set1_epi8((char)syms[2*s]);
+    __m256i sym1 = _mm256_set1_epi8((char)syms[2*s+1]);
+    __m256i t  = _mm256_avg_epu8(_mm256_xor_si256(sym0, bt0), _mm256_xor_si256(sym1, bt1));
+    __m256i tc, m0, m1, m2, m3, s0, s1, d0, d1, lo, hi;
+
+    t  = _mm256_and_si256(_mm256_srli_epi16(t, 2), max_bm);
+    tc = _mm256_sub_epi8(max_bm, t);
+    m0 = _mm256_adds_epu8(m[0], t);
+    m1 = _mm256_adds_epu8(m[1], tc);
+    m2 = _mm256_adds_epu8(m[0], tc);
+    m3 = _mm256_adds_epu8(m[1], t);
+    s0 = _mm256_min_epu8(m0, m1);
+    s1 = _mm256_min_epu8(m2, m3);
+    /* inverted decisions: set where the upper branch survived */
+    d0 = _mm256_cmpeq_epi8(s0, m0);
+    d1 = _mm256_cmpeq_epi8(s1, m2);
+
+    lo = _mm256_unpacklo_epi8(d0, d1);
+    hi = _mm256_unpackhi_epi8(d0, d1);
+    vp->decisions[s].w[0] = ~(uint32_t)_mm256_movemask_epi8(_mm256_permute2x128_si256(lo, hi, 0x20));
+    vp->decisions[s].w[1] = ~(uint32_t)_mm256_movemask_epi8(_mm256_permute2x128_si256(lo, hi, 0x31));
+
+    lo = _mm256_unpacklo_epi8(s0, s1);
+    hi = _mm256_unpackhi_epi8(s0, s1);
+    m[0] = _mm256_permute2x128_si256(lo, hi, 0x20);
+    m[1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+
+    /* Renormalize: subtract the smallest metric from every state */
+    min = _mm256_castsi256_si128(_mm256_min_epu8(m[0], m[1]));
+    min = _mm_min_epu8(min, _mm256_extracti128_si256(_mm256_min_epu8(m[0], m[1]), 1));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 8));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 4));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 2));
+    min = _mm_min_epu8(min, _mm_srli_si128(min, 1));
+    m[0] = _mm256_subs_epu8(m[0], _mm256_broadcastb_epi8(min));
+    m[1] = _mm256_subs_epu8(m[1], _mm256_broadcastb_epi8(min));
+  }
+
+  _mm256_store_si256((__m256i *)&tmp[0], m[0]);
+  _mm256_store_si256((__m256i *)&tmp[32], m[1]);
+  ao40_store_metrics_8(vp, tmp);
+}
+AO40_TARGET("avx512bw")
+void ao40_update_viterbi_avx512bw_16(struct ao40_v *vp, const uint8_t *syms, int nbits) {
+  uint16_t tmp[AO40_NUMSTATES] __attribute__ ((aligned (64)));
+  __m512i m[2], bt0, bt1;
+  const __m512i full = _mm512_set1_epi16(510);
+  const __m512i zero = _mm512_setzero_si512();
+  /* unpack works per 128-bit lane: gather lanes back into state order */
+  const __m512i lo_idx = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+  const __m512i hi_idx = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+  int i, s;
+
+  for (i = 0; i < AO40_NUMSTATES; ++i)
+    tmp[i] = (uint16_t)vp->branchtab[i];
+  bt0 = _mm512_load_si512((const void *)&tmp[0]);
+  bt1 = _mm512_load_si512((const void *)&tmp[AO40_NUMSTATES/2]);
+
+  ao40_load_metrics_16(vp, tmp);
+  m[0] = _mm512_load_si512((const void *)&tmp[0]);
+  m[1] = _mm512_load_si512((const void *)&tmp[32]);
+
+  for (s = 0; s < nbits; ++s) {
+    __m512i sym0 = _mm512_set1_epi16((short)syms[2*s]);
+    __m512i sym1 = _mm512_set1_epi16((short)syms[2*s+1]);
+    __m512i t  = _mm512_add_epi16(_mm512_xor_si512(sym0, bt0), _mm512_xor_si512(sym1, bt1));
+    __m512i tc = _mm512_sub_epi16(full, t);
+    __m512i m0 = _mm512_add_epi16(m[0], t);
+    __m512i m1 = _mm512_add_epi16(m[1], tc);
+    __m512i m2 = _mm512_add_epi16(m[0], tc);
+    __m512i m3 = _mm512_add_epi16(m[1], t);
+    __mmask32 d0 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m0, m1), zero);
+    __mmask32 d1 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m2, m3), zero);
+    __m512i s0 = _mm512_mask_blend_epi16(d0, m0, m1);
+    __m512i s1 = _mm512_mask_blend_epi16(d1, m2, m3);
+    __m512i v0 = _mm512_movm_epi16(d0);
+    __m512i v1 = _mm512_movm_epi16(d1);
+    __m512i lo = _mm512_unpacklo_epi16(v0, v1);
+    __m512i hi = _mm512_unpackhi_epi16(v0, v1);
+
+    vp->decisions[s].w[0] = (uint32_t)_mm512_movepi16_mask(_mm512_permutex2var_epi64(lo, lo_idx, hi));
+    vp->decisions[s].w[1] = (uint32_t)_mm512_movepi16_mask(_mm512_permutex2var_epi64(lo, hi_idx, hi));
+
+    lo = _mm512_unpacklo_epi16(s0, s1);
+    hi = _mm512_unpackhi_epi16(s0, s1);
+    m[0] = _mm512_permutex2var_epi64(lo, lo_idx, hi);
+    m[1] = _mm512_permutex2var_epi64(lo, hi_idx, hi);
+  }
+
+  _mm512_store_si512((void *)&tmp[0], m[0]);
+  _mm512_store_si512((void *)&tmp[32], m[1]);
+  ao40_store_metrics_16(vp, tmp);
+}
+#endif /* AO40_X86_KERNELS */
@@ -0,0 +1,49 @@
+#ifndef AO40_VIT_SIMD_H
+#define AO40_VIT_SIMD_H
+
+#include "ao40_cpu.h"
+#include "ao40_spiral-vit_scalar.h"
+
+/*
+ * SIMD add-compare-select kernels for the K=7 r=1/2 trellis.
+ *
+ * - The 16-bit kernels use wrapping path metrics and compare them through
+ *   their signed difference. The metric spread of this code is bounded by
+ *   (K-1)*510, so the decisions are bit-identical to the scalar engine.
+ * - The 8-bit kernels use 6-bit branch metrics, saturating path metrics and
+ *   renormalize on every step. They fill twice as many states per vector,
+ *   but only approximate the scalar decisions on noisy frames.
+ *
+ * Every kernel is compiled for its own target, pick one through
+ * ao40_dispatch.h instead of calling them directly.
+ *
+ * There is no SSE4.1 kernel: the 16-bit one gets by with the signed
+ * compares of SSE2 and the 8-bit one needs only PSHUFB from SSSE3, so an
+ * SSE4.1 build would run the same instructions on fewer CPUs.
+ */
+
+void ao40_update_viterbi_scalar(struct ao40_v *vp, const uint8_t *syms, int nbits);
+
+#ifdef AO40_X86_KERNELS
+void ao40_update_viterbi_sse2_16(struct ao40_v *vp, const uint8_t *syms, int nbits);
+void ao40_update_viterbi_ssse3_8(struct ao40_v *vp, const uint8_t *syms, int nbits);
+void ao40_update_viterbi_avx2_16(struct ao40_v *vp, const uint8_t *syms, int nbits);
+void ao40_update_viterbi_avx2_8(struct ao40_v *vp, const uint8_t *syms, int nbits);
+void ao40_update_viterbi_avx512bw_16(struct ao40_v *vp, const uint8_t *syms, int nbits);
+#endif
+
+/*
+ * Frame-parallel kernels: decode min(n, lanes) frames of AO40_FRAMEBITS+K-1
+ * symbol pairs each, one frame per 16-bit lane (8, 16 or 32 lanes), and
+ * return the number of frames taken. dec[step][state] gets one decision bit
+ * per frame, ao40_chainback_batch() walks it back for the first lanes frames.
+ */
+void ao40_chainback_batch(const uint32_t (*dec)[AO40_NUMSTATES], int lanes, uint8_t *const data[]);
+
+#ifdef AO40_X86_KERNELS
+int ao40_viterbi_batch_sse2(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40_NUMSTATES]);
+int ao40_viterbi_batch_avx2(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40_NUMSTATES]);
+int ao40_viterbi_batch_avx512bw(const uint8_t *const conv[], int n, uint32_t (*dec)[AO40_NUMSTATES]);
+#endif
+
+#endif /* AO40_VIT_SIMD_H */
@@ -0,0 +1,39 @@
+#ifndef AO40_VIT_SOVA_H
+#define AO40_VIT_SOVA_H
+
+#include <stdint.h>
+#include "ao40_spiral-vit_scalar.h"
+#include "ao40_vit_list.h"
+
+/*
+ * Soft output Viterbi (SOVA, Hagenauer's update rule) on top of a decoded
+ * frame.
+ *
+ * At every node of the best path the discarded path merging into it is
+ * worse by the metric gap there (ao40_list_gaps()). Tracing that path back
+ * until it rejoins the best one, every bit on which the two disagree could
+ * have been decided the other way at that cost. The reliability of a bit
+ * is the smallest such cost, in the units of the branch metric: one soft
+ * symbol moved from one end of 0..255 to the other is worth 255.
+ */
+
+#define AO40_SOVA_DEPTH 64    // rows a discarded path is traced back at most
+#ifndef AO40_SOVA_MAX
+#define AO40_SOVA_MAX   2040  // reliabilities saturate here (8 symbols flipped end to end)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/* vp holds the decisions of syms for the whole frame, decoded from state 0
+ * to state 0 (ao40_init_viterbi(vp, 0), exact metrics). Writes the
+ * reliability of every decoded bit, saturated to AO40_SOVA_MAX: paths
+ * that far behind are not traced back at all. */
+void ao40_sova(const struct ao40_v *vp, const uint8_t *syms, uint16_t rel[AO40_FRAMEBITS]);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif /* AO40_VIT_SOVA_H */
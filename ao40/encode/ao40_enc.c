@@ -11,65 +11,27 @@
 
 #include <stdint.h>
 #include "ao40_enc.h"
+#include "ao40_gf.h"
 
 #define AO40_SYNC_POLY      0x48
 #define AO40_SCRAMBLER_POLY 0x95
 #define AO40_CPOLYA         0x4f // 79
 #define AO40_CPOLYB         0x6d // 109
-#define AO40_GF_POLY        0x187
-#define AO40_A0             255
-
-const uint8_t RS_poly[] = {249,59,66,4,43,126,251,97,30,3,213,50,66,170,5,24};
-static uint8_t RS_block[2][32];
-static uint16_t Nbytes;
-static uint8_t Bmask;
-static uint16_t Bindex;
-static uint8_t Scrambler;
-static uint8_t Conv_sr;
-static uint8_t *Interleaver;
+#define AO40_INTERLEAVER_ROWS 65  // the 650 bytes are this matrix of bits,
+#define AO40_INTERLEAVER_COLS 80  // written by columns, sent by rows
+
+
+#if defined(AO40_LOW_MEMORY) && (defined(AO40_GF_MUL_TABLE) || defined(AO40_RS_ENC_TABLE))
+#error "AO40_LOW_MEMORY excludes AO40_GF_MUL_TABLE and AO40_RS_ENC_TABLE"
+#endif
 
 // memory workaround: to LUT or not to LUT...
 #ifndef AO40_LOW_MEMORY
-  // No need for low memory, use LUT
-  #define INDEX_OF(x) ( Index_of[ (x) ] )
-  #define ALPHA_TO(x) ( Alpha_to[ (x) ] )
-  static const uint8_t Alpha_to[] = {
-    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x87, 0x89, 0x95, 0xad, 0xdd, 0x3d, 0x7a, 0xf4,
-    0x6f, 0xde, 0x3b, 0x76, 0xec, 0x5f, 0xbe, 0xfb, 0x71, 0xe2, 0x43, 0x86, 0x8b, 0x91, 0xa5, 0xcd,
-    0x1d, 0x3a, 0x74, 0xe8, 0x57, 0xae, 0xdb, 0x31, 0x62, 0xc4, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0x67,
-    0xce, 0x1b, 0x36, 0x6c, 0xd8, 0x37, 0x6e, 0xdc, 0x3f, 0x7e, 0xfc, 0x7f, 0xfe, 0x7b, 0xf6, 0x6b,
-    0xd6, 0x2b, 0x56, 0xac, 0xdf, 0x39, 0x72, 0xe4, 0x4f, 0x9e, 0xbb, 0xf1, 0x65, 0xca, 0x13, 0x26,
-    0x4c, 0x98, 0xb7, 0xe9, 0x55, 0xaa, 0xd3, 0x21, 0x42, 0x84, 0x8f, 0x99, 0xb5, 0xed, 0x5d, 0xba,
-    0xf3, 0x61, 0xc2, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
-    0x47, 0x8e, 0x9b, 0xb1, 0xe5, 0x4d, 0x9a, 0xb3, 0xe1, 0x45, 0x8a, 0x93, 0xa1, 0xc5, 0x0d, 0x1a,
-    0x34, 0x68, 0xd0, 0x27, 0x4e, 0x9c, 0xbf, 0xf9, 0x75, 0xea, 0x53, 0xa6, 0xcb, 0x11, 0x22, 0x44,
-    0x88, 0x97, 0xa9, 0xd5, 0x2d, 0x5a, 0xb4, 0xef, 0x59, 0xb2, 0xe3, 0x41, 0x82, 0x83, 0x81, 0x85,
-    0x8d, 0x9d, 0xbd, 0xfd, 0x7d, 0xfa, 0x73, 0xe6, 0x4b, 0x96, 0xab, 0xd1, 0x25, 0x4a, 0x94, 0xaf,
-    0xd9, 0x35, 0x6a, 0xd4, 0x2f, 0x5e, 0xbc, 0xff, 0x79, 0xf2, 0x63, 0xc6, 0x0b, 0x16, 0x2c, 0x58,
-    0xb0, 0xe7, 0x49, 0x92, 0xa3, 0xc1, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0xc7, 0x09, 0x12, 0x24,
-    0x48, 0x90, 0xa7, 0xc9, 0x15, 0x2a, 0x54, 0xa8, 0xd7, 0x29, 0x52, 0xa4, 0xcf, 0x19, 0x32, 0x64,
-    0xc8, 0x17, 0x2e, 0x5c, 0xb8, 0xf7, 0x69, 0xd2, 0x23, 0x46, 0x8c, 0x9f, 0xb9, 0xf5, 0x6d, 0xda,
-    0x33, 0x66, 0xcc, 0x1f, 0x3e, 0x7c, 0xf8, 0x77, 0xee, 0x5b, 0xb6, 0xeb, 0x51, 0xa2, 0xc3, 0x00,
-  };
-
-  static const uint8_t Index_of[] = {
-   0xff, 0x00, 0x01, 0x63, 0x02, 0xc6, 0x64, 0x6a, 0x03, 0xcd, 0xc7, 0xbc, 0x65, 0x7e, 0x6b, 0x2a,
-   0x04, 0x8d, 0xce, 0x4e, 0xc8, 0xd4, 0xbd, 0xe1, 0x66, 0xdd, 0x7f, 0x31, 0x6c, 0x20, 0x2b, 0xf3,
-   0x05, 0x57, 0x8e, 0xe8, 0xcf, 0xac, 0x4f, 0x83, 0xc9, 0xd9, 0xd5, 0x41, 0xbe, 0x94, 0xe2, 0xb4,
-   0x67, 0x27, 0xde, 0xf0, 0x80, 0xb1, 0x32, 0x35, 0x6d, 0x45, 0x21, 0x12, 0x2c, 0x0d, 0xf4, 0x38,
-   0x06, 0x9b, 0x58, 0x1a, 0x8f, 0x79, 0xe9, 0x70, 0xd0, 0xc2, 0xad, 0xa8, 0x50, 0x75, 0x84, 0x48,
-   0xca, 0xfc, 0xda, 0x8a, 0xd6, 0x54, 0x42, 0x24, 0xbf, 0x98, 0x95, 0xf9, 0xe3, 0x5e, 0xb5, 0x15,
-   0x68, 0x61, 0x28, 0xba, 0xdf, 0x4c, 0xf1, 0x2f, 0x81, 0xe6, 0xb2, 0x3f, 0x33, 0xee, 0x36, 0x10,
-   0x6e, 0x18, 0x46, 0xa6, 0x22, 0x88, 0x13, 0xf7, 0x2d, 0xb8, 0x0e, 0x3d, 0xf5, 0xa4, 0x39, 0x3b,
-   0x07, 0x9e, 0x9c, 0x9d, 0x59, 0x9f, 0x1b, 0x08, 0x90, 0x09, 0x7a, 0x1c, 0xea, 0xa0, 0x71, 0x5a,
-   0xd1, 0x1d, 0xc3, 0x7b, 0xae, 0x0a, 0xa9, 0x91, 0x51, 0x5b, 0x76, 0x72, 0x85, 0xa1, 0x49, 0xeb,
-   0xcb, 0x7c, 0xfd, 0xc4, 0xdb, 0x1e, 0x8b, 0xd2, 0xd7, 0x92, 0x55, 0xaa, 0x43, 0x0b, 0x25, 0xaf,
-   0xc0, 0x73, 0x99, 0x77, 0x96, 0x5c, 0xfa, 0x52, 0xe4, 0xec, 0x5f, 0x4a, 0xb6, 0xa2, 0x16, 0x86,
-   0x69, 0xc5, 0x62, 0xfe, 0x29, 0x7d, 0xbb, 0xcc, 0xe0, 0xd3, 0x4d, 0x8c, 0xf2, 0x1f, 0x30, 0xdc,
-   0x82, 0xab, 0xe7, 0x56, 0xb3, 0x93, 0x40, 0xd8, 0x34, 0xb0, 0xef, 0x26, 0x37, 0x0c, 0x11, 0x44,
-   0x6f, 0x78, 0x19, 0x9a, 0x47, 0x74, 0xa7, 0xc1, 0x23, 0x53, 0x89, 0xfb, 0x14, 0x5d, 0xf8, 0x97,
-   0x2e, 0x4b, 0xb9, 0x60, 0x0f, 0xed, 0x3e, 0xe5, 0xf6, 0x87, 0xa5, 0x17, 0x3a, 0xa3, 0x3c, 0xb7,
-  };
+  // No need for low memory, use the LUTs of ao40_gf.c
+  #define INDEX_OF(x) ( AO40_INDEX_OF[ (x) ] )
+  #define ALPHA_TO(x) ( AO40_ALPHA_TO[ (x) ] )
+  #define ALPHA_TO_SUM(x, y) ( AO40_ALPHA_TO_X[ (x) + (y) ] )
+  #define RS_POLY(i) ( AO40_RS_GENPOLY[AO40_NROOTS-1-(i)] )
 #else
   // Keep memory footprint low
   #define INDEX_OF(x) ( index_of_func( (x) ) )
@@ -109,13 +71,18 @@ static uint8_t *Interleaver;
     return sr;
   }
 
-#endif /* AO40_LOW_MEMORY */
+  static inline uint8_t mod255(uint16_t x){
+    while (x >= 255)
+      x -= 255;
+    return x;
+  }
 
-static inline uint8_t mod255(uint16_t x){
-  while (x >= 255)
-    x -= 255;
-  return x;
-}
+  #define ALPHA_TO_SUM(x, y) ( alpha_to_func(mod255((x) + (y))) )
+  #define RS_POLY(i) ( RS_poly[ (i) ] )
+  // AO40_RS_GENPOLY[AO40_NROOTS-1-i] of ao40_gf.c, which this build goes without
+  static const uint8_t RS_poly[] = {249,59,66,4,43,126,251,97,30,3,213,50,66,170,5,24};
+
+#endif /* AO40_LOW_MEMORY */
 
 static inline uint8_t parity(uint8_t x){
   x ^= x >> 4;
@@ -124,110 +91,257 @@ static inline uint8_t parity(uint8_t x){
   return x & 1;
 }
 
-static void interleave_symbol(uint8_t c){
+#ifndef AO40_LOW_MEMORY
+/*
+ * The symbols are first stored in the output in the order they are coded,
+ * that is column after column of the interleaver matrix, bindex counting
+ * the bytes. interleave_frame() then transposes them into rows.
+ */
+
+// 8 bits from bit position bit on, MSB first
+static inline uint8_t get8(const uint8_t *p, uint16_t bit){
+  return (uint8_t)(((p[bit >> 3] << 8) | p[(bit >> 3) + 1]) >> (8 - (bit & 7)));
+}
+
+// 8x8 bit matrix transpose, rows as the bytes of x from the MSB
+static inline uint64_t transpose8(uint64_t x){
+  uint64_t t;
+
+  t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+static void interleave_frame(struct ao40_encoder *e){
+  // the sync column, then the symbols: 65 + 5135 bits and get8() slack
+  uint8_t in[AO40_INTERLEAVER_ROWS*AO40_INTERLEAVER_COLS/8 + 2];
+  uint8_t carry, r0, rb, c0, m;
+  uint16_t i, sr;
+  uint64_t x;
+
+  for (i = 0; i < 9; ++i)
+    in[i] = 0;
+  sr = 0x7f;
+  for (i = 0; i < AO40_INTERLEAVER_ROWS; ++i) {
+    if (sr & 0x40)
+      in[i >> 3] |= 0x80 >> (i & 7);
+    sr = (sr << 1) | parity(sr & AO40_SYNC_POLY);
+  }
+  // the symbols follow the 65th sync bit
+  carry = in[8];
+  for (i = 0; i < e->bindex; ++i) {
+    in[8+i] = carry | (e->interleaver[i] >> 1);
+    carry = e->interleaver[i] << 7;
+  }
+  in[8+i] = carry;
+  for (++i; 8+i < (uint16_t)sizeof(in); ++i)
+    in[8+i] = 0;
+
+  // 8x8 blocks; the last row block overlaps the one before it
+  for (r0 = 0; r0 < AO40_INTERLEAVER_ROWS; r0 += 8) {
+    rb = (r0 + 8 > AO40_INTERLEAVER_ROWS) ? AO40_INTERLEAVER_ROWS - 8 : r0;
+    for (c0 = 0; c0 < AO40_INTERLEAVER_COLS; c0 += 8) {
+      x = 0;
+      for (m = 0; m < 8; ++m)
+        x = (x << 8) | get8(in, (c0 + m) * AO40_INTERLEAVER_ROWS + rb);
+      x = transpose8(x);
+      for (m = 0; m < 8; ++m)
+        e->interleaver[((rb + m) * AO40_INTERLEAVER_COLS + c0) >> 3] = (uint8_t)(x >> (56 - 8*m));
+    }
+  }
+}
+
+// [state][nibble]: the 8 symbols of 4 input bits, the first one in the MSB.
+// The state is the last 6 input bits, all the K=7 code remembers.
+static uint8_t Conv_tab[64][16];
+
+__attribute__ ((constructor))
+static void init_conv_tab(void){
+  uint8_t state, x, i, sr, sym;
+
+  for (state = 0; state < 64; ++state) {
+    for (x = 0; x < 16; ++x) {
+      sr = state;
+      sym = 0;
+      for (i = 0; i < 4; ++i) {
+        sr = (sr << 1) | ((x >> (3-i)) & 1);
+        sym = (sym << 2) | (parity(sr & AO40_CPOLYA) << 1) | !parity(sr & AO40_CPOLYB);
+      }
+      Conv_tab[state][x] = sym;
+    }
+  }
+}
+
+static void encode_and_interleave(struct ao40_encoder *e, uint8_t c, uint8_t cnt){
+  uint8_t n, sym;
+
+  // a nibble per lookup; conv_sr holds the 6 bit state only
+  while (cnt != 0) {
+    n = (cnt < 4) ? cnt : 4;
+    sym = Conv_tab[e->conv_sr][c >> 4];
+    e->conv_sr = ((e->conv_sr << n) | (c >> (8-n))) & 0x3f;
+    c <<= 4;
+    cnt -= n;
+    e->interleaver[e->bindex++] = sym & (0xff << (8 - 2*n));
+  }
+}
+
+static void scramble_and_encode(struct ao40_encoder *e, uint8_t c){
+  encode_and_interleave(e, c ^ ao40_Scrambler[e->nbytes], 8);
+}
+#else
+static void interleave_symbol(struct ao40_encoder *e, uint8_t c){
   if (c)
-    Interleaver[Bindex] |= Bmask;
+    e->interleaver[e->bindex] |= e->bmask;
   else
-    Interleaver[Bindex] &= ~Bmask;
-
-  Bindex += 10;
-  if (Bindex >= 650){
-    Bindex -= 650;
-    Bmask >>= 1;
-    if (Bmask == 0){
-      Bmask = 0x80;
-      ++Bindex;
+    e->interleaver[e->bindex] &= ~e->bmask;
+
+  e->bindex += 10;
+  if (e->bindex >= 650){
+    e->bindex -= 650;
+    e->bmask >>= 1;
+    if (e->bmask == 0){
+      e->bmask = 0x80;
+      ++e->bindex;
     }
   }
 }
 
-static void encode_and_interleave(uint8_t c, uint8_t cnt){
+static void encode_and_interleave(struct ao40_encoder *e, uint8_t c, uint8_t cnt){
   while(cnt-- != 0){
-    Conv_sr = (Conv_sr << 1) | (c >> 7);
+    e->conv_sr = (e->conv_sr << 1) | (c >> 7);
     c <<= 1;
-    interleave_symbol(parity(Conv_sr & AO40_CPOLYA));
-    interleave_symbol(!parity(Conv_sr & AO40_CPOLYB)); /* Second encoder symbol is inverted */
+    interleave_symbol(e, parity(e->conv_sr & AO40_CPOLYA));
+    interleave_symbol(e, !parity(e->conv_sr & AO40_CPOLYB)); /* Second encoder symbol is inverted */
   }    
 }
 
-static void scramble_and_encode(uint8_t c){
+static void scramble_and_encode(struct ao40_encoder *e, uint8_t c){
   uint8_t i;
 
-  c ^= Scrambler;
+  c ^= e->scrambler;
   for (i = 0; i < 8; ++i)
-    Scrambler = (Scrambler << 1) | parity(Scrambler & AO40_SCRAMBLER_POLY);
-  encode_and_interleave(c, 8);
+    e->scrambler = (e->scrambler << 1) | parity(e->scrambler & AO40_SCRAMBLER_POLY);
+  encode_and_interleave(e, c, 8);
 }
+#endif /* AO40_LOW_MEMORY */
 
-void reset_encoder(void){
+static void reset_encoder(struct ao40_encoder *e){
   uint8_t i;
 
-  Nbytes = 0;
-  Conv_sr = 0;
-  Scrambler = 0xff;
-  Bmask = 0x40;
-  Bindex = 0;
-  for(i=0;i<32;i++) {
-    RS_block[0][i] = 0;
-    RS_block[1][i] = 0;
+  e->nbytes = 0;
+  e->conv_sr = 0;
+#ifdef AO40_LOW_MEMORY
+  e->scrambler = 0xff;
+#endif
+  e->bmask = 0x40;
+  e->bindex = 0;
+  for(i=0;i<AO40_NROOTS;i++) {
+    e->rs_block[0][i] = 0;
+    e->rs_block[1][i] = 0;
   }
 }
 
-void init_encoder(void){
+static void init_encoder(struct ao40_encoder *e){
+#ifdef AO40_LOW_MEMORY
   uint8_t i;
   uint16_t sr;
 
   for (sr = 0; sr < 650; ++sr)   // sr is used because its 16bit width
-    Interleaver[sr] = 0;         // to preserve memory
+    e->interleaver[sr] = 0;         // to preserve memory
   
   // TODO: write a little script for this to get the output
   sr = 0x7f;
   for (i = 0; i < 65; ++i) {
     if(sr & 64) { // TODO: 0x40
-      Interleaver[10*i] |= 0x80;
+      e->interleaver[10*i] |= 0x80;
     }
     sr = (sr << 1) | parity(sr & AO40_SYNC_POLY);
   }
-  reset_encoder();
+#endif
+  // otherwise interleave_frame() writes all of the output, sync included
+  reset_encoder(e);
 }
 
-void encode_byte(uint8_t c){
+static void encode_byte(struct ao40_encoder *e, uint8_t c){
   uint8_t *rp;
   uint8_t i;
-  uint8_t feedback;
+#if defined(AO40_RS_ENC_TABLE)
+  const uint8_t *row;
+  uint8_t reg[AO40_NROOTS];
+#elif defined(AO40_GF_MUL_TABLE)
   uint8_t t;
+  const uint8_t *row;
+#else
+  uint8_t t;
+  uint8_t feedback;
+#endif
 
-  rp = RS_block[Nbytes & 1];
+  rp = e->rs_block[e->nbytes & 1];
+#if defined(AO40_RS_ENC_TABLE)
+  // the whole update of the feedback byte in one row, added as it shifts;
+  // shifting into a local copy lets the compiler XOR it as whole vectors
+  row = AO40_RS_ENC[c ^ rp[0]];
+  for (i = 0; i < AO40_NROOTS-1; ++i)
+    reg[i] = rp[i+1];
+  reg[AO40_NROOTS-1] = 0;
+  for (i = 0; i < AO40_NROOTS; ++i)
+    reg[i] ^= row[i];
+  for (i = 0; i < AO40_NROOTS; ++i)
+    rp[i] = reg[i];
+#elif defined(AO40_GF_MUL_TABLE)
+  // poly-form feedback: its row of the product table has all the terms
+  row = AO40_GF_MUL[c ^ rp[0]];
+  for (i = 0; i < AO40_NROOTS/2-1; ++i) {
+    t = row[ALPHA_TO(RS_POLY(i))];
+    rp[i+1] ^= t;
+    rp[AO40_NROOTS-1-i] ^= t;
+  }
+  rp[AO40_NROOTS/2] ^= row[ALPHA_TO(RS_POLY(AO40_NROOTS/2-1))];
+
+  for (i = 0; i < AO40_NROOTS-1; ++i)
+    rp[i] = rp[i+1];
+  rp[AO40_NROOTS-1] = row[1];
+#else
   feedback = INDEX_OF(c ^ rp[0]);
   
+  // the generator polynomial is symmetric: its terms i+1 and NROOTS-1-i match
   if (feedback != AO40_A0){
-    for (i = 0; i < 15; ++i) {
-      t = ALPHA_TO(mod255(feedback + RS_poly[i]));
+    for (i = 0; i < AO40_NROOTS/2-1; ++i) {
+      t = ALPHA_TO_SUM(feedback, RS_POLY(i));
       rp[i+1] ^= t;
-      rp[31-i] ^= t;
+      rp[AO40_NROOTS-1-i] ^= t;
     }
-    rp[16] ^= ALPHA_TO(mod255(feedback + RS_poly[15]));
+    rp[AO40_NROOTS/2] ^= ALPHA_TO_SUM(feedback, RS_POLY(AO40_NROOTS/2-1));
   }
   
-  for (i = 0; i < 31; ++i)
+  for (i = 0; i < AO40_NROOTS-1; ++i)
     rp[i] = rp[i+1];
 
   if (feedback != AO40_A0){
-    rp[31] = ALPHA_TO(feedback);
+    rp[AO40_NROOTS-1] = ALPHA_TO(feedback);
   } else {
-    rp[31] = 0;
+    rp[AO40_NROOTS-1] = 0;
   }
-  scramble_and_encode(c);
-  ++Nbytes;
+#endif
+  scramble_and_encode(e, c);
+  ++e->nbytes;
 }  
 
-void encode_parity(void) {
+static void encode_parity(struct ao40_encoder *e){
   uint8_t c;
 
-  c =  RS_block[Nbytes & 1][(Nbytes >> 1) - 128];
-  scramble_and_encode(c);
-  if (++Nbytes == 320) {
-    encode_and_interleave(0, 6);
+  c =  e->rs_block[e->nbytes & 1][(e->nbytes >> 1) - 128];
+  scramble_and_encode(e, c);
+  if (++e->nbytes == 320) {
+    encode_and_interleave(e, 0, 6);
+#ifndef AO40_LOW_MEMORY
+    interleave_frame(e);
+#endif
   }
 }
 
@@ -241,42 +355,101 @@ void encode_parity(void) {
  *             It holds the encoded data in byte format
  */ 
 
-void encode_data_ao40(const uint8_t data[256], uint8_t encoded[650]) {
-  uint16_t i;
-
+void encode_begin_ao40(struct ao40_encoder *e, uint8_t encoded[650]) {
   // Use already allocated array to store encoded data
-  Interleaver = encoded;
+  e->interleaver = encoded;
+
+  init_encoder(e);
+  reset_encoder(e);
+}
+
+int encode_push_ao40(struct ao40_encoder *e, const uint8_t *data, int n) {
+  int i;
 
-  init_encoder();
-  reset_encoder();
+  if (n <= 0 || e->nbytes >= 256)
+    return 0;  // nothing to take, or all data in and parity comes next
+  if (n > 256 - e->nbytes)
+    n = 256 - e->nbytes;
+
+  for (i = 0; i < n; ++i) {
+    encode_byte(e, data[i]);
+  }
+  return n;
+}
+
+void encode_finish_ao40(struct ao40_encoder *e) {
+  while (e->nbytes < 256) {
+    encode_byte(e, 0);
+  }
 
+  while (e->nbytes < 320) {
+    encode_parity(e);
+  }
+}
+
+void encode_data_ao40_r(struct ao40_encoder *e, const uint8_t data[256], uint8_t encoded[650]) {
+  encode_begin_ao40(e, encoded);
+  encode_push_ao40(e, data, 256);
+  encode_finish_ao40(e);
+}
+
+void encode_data_ao40_parity_r(struct ao40_encoder *e, const uint8_t data[256], const uint8_t parity[2][AO40_NROOTS], uint8_t encoded[650]) {
+  uint16_t i;
+
+  encode_begin_ao40(e, encoded);
   for (i = 0; i < 256; ++i) {
-    encode_byte(data[i]);
+    scramble_and_encode(e, data[i]);
+    ++e->nbytes;
+  }
+  for (i = 0; i < AO40_NROOTS; ++i) {
+    e->rs_block[0][i] = parity[0][i];
+    e->rs_block[1][i] = parity[1][i];
   }
+  encode_finish_ao40(e);
+}
+
+int encode_data_ao40_iov_r(struct ao40_encoder *e, const struct ao40_iovec iov[], int iovcnt, uint8_t encoded[650]) {
+  size_t total = 0;
+  int i;
 
-  for (i = 0; i < 64; ++i) {
-    encode_parity();
+  // fragment by fragment, so that neither total nor the int length wraps
+  for (i = 0; i < iovcnt; ++i) {
+    if (iov[i].len > 256 - total)
+      return -1;
+    total += iov[i].len;
   }
+  if (total != 256)
+    return -1;
+
+  encode_begin_ao40(e, encoded);
+  for (i = 0; i < iovcnt; ++i)
+    encode_push_ao40(e, iov[i].base, (int)iov[i].len);  // at most 256 each
+  encode_finish_ao40(e);
+  return 0;
+}
+
+int encode_data_ao40_iov(const struct ao40_iovec iov[], int iovcnt, uint8_t encoded[650]) {
+  struct ao40_encoder e;
+
+  return encode_data_ao40_iov_r(&e, iov, iovcnt, encoded);
+}
+
+void encode_data_ao40(const uint8_t data[256], uint8_t encoded[650]) {
+  struct ao40_encoder e;
+
+  encode_data_ao40_r(&e, data, encoded);
 }
 
 // for testing purpose enable built-in byte->bit converter
 #ifdef AO40_ENABLE_BIT_OUTPUT
 void encode_data_bit_ao40(const uint8_t data[256], uint8_t bit_encoded[5200]) {
-  uint8_t encoded[650] = {0};
-  uint16_t i;
+  uint8_t encoded[650];
 
-  // encode to byte format
-  encode_data(data, encoded);
-
-  // convert to bit format: simply put 0 and 1 to the corresponding byte
-  for (i = 0; i < 5200; ++i) {
+  encode_data_ao40(data, encoded);
 #ifdef MSBFIRST
-    // MSB first
-    bit_encoded[i] = ( (encoded[i >> 3] & (1 << (7 - (i & 7)))) != 0 );
+  ao40_unpack_bits(encoded, bit_encoded, AO40_MSB_FIRST);
 #else
-    // LSB first
-    bit_encoded[i] = ( (encoded[i >> 3] & (1 << (i & 7))) != 0 );
+  ao40_unpack_bits(encoded, bit_encoded, AO40_LSB_FIRST);
 #endif
-  }
 }
 #endif /* AO40_ENABLE_BIT_OUTPUT */
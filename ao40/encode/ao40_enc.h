@@ -2,10 +2,13 @@
 #ifndef AO40_ENC_H
 #define AO40_ENC_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include "ao40_gf.h"
 
-//#define AO40_LOW_MEMORY          // low memory workaround to avoid LUT (and preserve 512byte)
+//#define AO40_LOW_MEMORY          // low memory workaround to avoid LUT (and preserve 512byte), ao40_gf.c is not needed then
 //#define AO40_ENABLE_BIT_OUTPUT  // enable debug bit output mode
+//#define AO40_ENABLE_THREADS     // encode_data_ao40_mt(), needs -pthread
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,10 +17,95 @@ extern "C" {
 #define AO40_DATA_SIZE      256
 #define AO40_CODE_LENGTH    650
 
+/* Encoder state: the _r functions keep all of it here, so separate encoders
+ * can encode in parallel. encode_data_ao40() keeps one on the stack.
+ */
+struct ao40_encoder {
+  uint8_t rs_block[2][AO40_NROOTS];  // parity of the two interleaved RS words
+  uint16_t nbytes;       // RS bytes coded so far
+  uint16_t bindex;       // output byte the next symbols go to
+  uint8_t bmask;         // and their bit, AO40_LOW_MEMORY only
+  uint8_t scrambler;     // scrambler LFSR, AO40_LOW_MEMORY only
+  uint8_t conv_sr;       // convolutional encoder state
+  uint8_t *interleaver;  // the output
+};
+
 void encode_data_ao40(const uint8_t data[AO40_DATA_SIZE], uint8_t encoded[AO40_CODE_LENGTH]);
+void encode_data_ao40_r(struct ao40_encoder *e, const uint8_t data[AO40_DATA_SIZE], uint8_t encoded[AO40_CODE_LENGTH]);
+
+/* The same a few bytes at a time, as the payload is put together: begin,
+ * push the data bytes in any pieces, then finish writes the parity and
+ * completes encoded. Push returns the bytes it took, those up to
+ * AO40_DATA_SIZE in all, and 0 for n < 0; finish takes zeros for the ones
+ * not pushed. encoded holds the frame only after finish: push stores the
+ * coded symbols there in column order, and finish does the whole
+ * interleaver transpose into rows (with AO40_LOW_MEMORY the symbols go
+ * straight to their place instead). */
+void encode_begin_ao40(struct ao40_encoder *e, uint8_t encoded[AO40_CODE_LENGTH]);
+int encode_push_ao40(struct ao40_encoder *e, const uint8_t *data, int n);
+void encode_finish_ao40(struct ao40_encoder *e);
+
+/* Payload in pieces, as struct iovec: the fragments are read in place, in
+ * order, and must add up to AO40_DATA_SIZE bytes. Returns 0, or -1 with
+ * nothing written if they do not. */
+struct ao40_iovec {
+  const void *base;
+  size_t len;
+};
+int encode_data_ao40_iov(const struct ao40_iovec iov[], int iovcnt, uint8_t encoded[AO40_CODE_LENGTH]);
+int encode_data_ao40_iov_r(struct ao40_encoder *e, const struct ao40_iovec iov[], int iovcnt, uint8_t encoded[AO40_CODE_LENGTH]);
+
+/* As encode_data_ao40_r(), the parity of the two interleaved RS words,
+ * parity[k] that of data[k], data[k+2], ..., formed already */
+void encode_data_ao40_parity_r(struct ao40_encoder *e, const uint8_t data[AO40_DATA_SIZE], const uint8_t parity[2][AO40_NROOTS], uint8_t encoded[AO40_CODE_LENGTH]);
+
+/* Encodes n frames, byte-identical to encode_data_ao40() on each. From
+ * the SSSE3 level of ao40_cpu.h on the RS parity of AO40_ENC_BATCH frames
+ * is formed at once, one RS word per vector lane, see ao40_enc_batch.c.
+ * AO40_KERNEL and ao40_set_kernel() pin the level as for the decoder.
+ */
+#define AO40_ENC_BATCH 32  // frames per round, their 64 words fill an AVX-512 vector
+void encode_data_ao40_batch(const uint8_t *const data[], uint8_t *const encoded[], int n);
+
+#ifdef AO40_ENABLE_THREADS
+/* As encode_data_ao40_batch(), the rounds spread over threads (0: one per
+ * online CPU), at most one per round. Worth it from a few hundred frames
+ * on. */
+void encode_data_ao40_mt(const uint8_t *const data[], uint8_t *const encoded[], int n, int threads);
+#endif
+
+/* Incremental encoding, see ao40_enc_delta.c: bit[p][b] is what flipping
+ * bit b (0: MSB) of payload byte p flips in the encoded frame. Create the
+ * table once (about 1.3 MB, a few ms to build) and share it read-only. */
+struct ao40_enc_delta {
+  uint8_t bit[AO40_DATA_SIZE][8][AO40_CODE_LENGTH];
+};
+
+struct ao40_enc_delta *ao40_create_enc_delta(void);  // NULL if out of memory
+void ao40_delete_enc_delta(struct ao40_enc_delta *t);
+
+/* Sets data[offset[i]] = value[i] for the n changes in order and patches
+ * encoded, the frame of data, to match: the result is what
+ * encode_data_ao40() makes of the new data. Returns 0, or -1 with nothing
+ * changed if an offset is out of range. */
+int encode_update_ao40(const struct ao40_enc_delta *t, uint8_t data[AO40_DATA_SIZE], uint8_t encoded[AO40_CODE_LENGTH],
+                       const uint16_t offset[], const uint8_t value[], int n);
+
+/* Output formats, see ao40_enc_out.c: the encoded frame unpacked to one
+ * symbol per element, in the order they are sent. MSB first starts with
+ * bit 7 of encoded[0], LSB first with bit 0. A 1 bit becomes 1, +amp or
+ * +1.0f and a 0 bit 0, -amp or -1.0f, as the decoder takes soft symbols;
+ * amp is 1 to 127, smaller values are taken as 1. */
+#define AO40_MSB_FIRST 0
+#define AO40_LSB_FIRST 1
+#define AO40_CODE_BITS (8*AO40_CODE_LENGTH)
+
+void ao40_unpack_bits(const uint8_t encoded[AO40_CODE_LENGTH], uint8_t bits[AO40_CODE_BITS], int order);
+void ao40_unpack_s8(const uint8_t encoded[AO40_CODE_LENGTH], int8_t syms[AO40_CODE_BITS], int8_t amp, int order);
+void ao40_unpack_float(const uint8_t encoded[AO40_CODE_LENGTH], float syms[AO40_CODE_BITS], int order);
 
 #ifdef AO40_ENABLE_BIT_OUTPUT
-void encode_data_bit(const uint8_t *data, uint8_t *bit_encoded);
+void encode_data_bit_ao40(const uint8_t data[AO40_DATA_SIZE], uint8_t bit_encoded[AO40_CODE_BITS]);
 #endif
 
 #ifdef __cplusplus
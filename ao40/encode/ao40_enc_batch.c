@@ -0,0 +1,263 @@
+/*
+ * Batch and multi-threaded AO-40 encoder
+ *
+ * The RS encoder is a shift register fed back through the data: every data
+ * byte waits on the register the previous one left. Across frames there is
+ * no such dependency, so the batch kernels put one RS word in every vector
+ * lane and run the register of all of them at once, byte j of every word
+ * in one vector:
+ *
+ *   fb = data[j] ^ reg[0]
+ *   reg[i] = reg[i+1] ^ fb * g[31-i],  reg[31] = fb * g[0]
+ *
+ * Every product is by a constant term of g(x), done by the nibble-split
+ * table lookup (PSHUFB) of
+ *
+ *   c * x = lo_c[x & 15] ^ hi_c[x >> 4]
+ *
+ * and g(x) being symmetric, 16 of them cover the 31 terms; g[0] is 1. The
+ * scrambler, the convolutional code and the interleaver then go frame by
+ * frame through encode_data_ao40_parity_r().
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ao40_enc.h"
+#include "ao40_cpu.h"
+
+#ifdef AO40_ENABLE_THREADS
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+#if defined(AO40_X86_KERNELS) && !defined(AO40_LOW_MEMORY)
+#define AO40_ENC_KERNELS
+#include <immintrin.h>
+#endif
+
+#ifdef AO40_ENC_KERNELS
+
+#define AO40_ENC_LANES (2*AO40_ENC_BATCH)  // RS words per round
+#define AO40_ENC_WORD  (AO40_DATA_SIZE/2)  // data bytes per RS word
+
+/* [i][lo, hi][x]: g[31-i] * x and g[31-i] * (x << 4), i < 16 */
+static uint8_t ao40_enc_tab[AO40_NROOTS/2][2][16] __attribute__ ((aligned (16)));
+
+/* Kernels: col[j][l] byte j of word l, par[i][l] gets its parity byte i.
+ * The lanes from lanes up to the vector width are computed but unused. */
+typedef void (*ao40_enc_parity_t)(const uint8_t (*col)[AO40_ENC_LANES], uint8_t (*par)[AO40_ENC_LANES], int lanes);
+
+AO40_TARGET("ssse3")
+static void ao40_enc_parity_ssse3(const uint8_t (*col)[AO40_ENC_LANES], uint8_t (*par)[AO40_ENC_LANES], int lanes) {
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  __m128i reg[AO40_NROOTS], fb, lo, hi, t;
+  int l, i, j;
+
+  for (l = 0; l < lanes; l += 16) {
+    for (i = 0; i < AO40_NROOTS; ++i)
+      reg[i] = _mm_setzero_si128();
+    for (j = 0; j < AO40_ENC_WORD; ++j) {
+      fb = _mm_xor_si128(_mm_load_si128((const __m128i *)(col[j] + l)), reg[0]);
+      lo = _mm_and_si128(fb, mask);
+      hi = _mm_and_si128(_mm_srli_epi16(fb, 4), mask);
+#pragma GCC unroll 32
+      for (i = 0; i < AO40_NROOTS-1; ++i)
+        reg[i] = reg[i+1];
+      reg[AO40_NROOTS-1] = fb;
+#pragma GCC unroll 16
+      for (i = 0; i < AO40_NROOTS/2; ++i) {
+        t = _mm_xor_si128(_mm_shuffle_epi8(_mm_load_si128((const __m128i *)ao40_enc_tab[i][0]), lo),
+                          _mm_shuffle_epi8(_mm_load_si128((const __m128i *)ao40_enc_tab[i][1]), hi));
+        reg[i] = _mm_xor_si128(reg[i], t);
+        if (i < AO40_NROOTS/2-1)
+          reg[AO40_NROOTS-2-i] = _mm_xor_si128(reg[AO40_NROOTS-2-i], t);
+      }
+    }
+    for (i = 0; i < AO40_NROOTS; ++i)
+      _mm_store_si128((__m128i *)(par[i] + l), reg[i]);
+  }
+}
+
+AO40_TARGET("avx2")
+static void ao40_enc_parity_avx2(const uint8_t (*col)[AO40_ENC_LANES], uint8_t (*par)[AO40_ENC_LANES], int lanes) {
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  __m256i reg[AO40_NROOTS], fb, lo, hi, t;
+  int l, i, j;
+
+  for (l = 0; l < lanes; l += 32) {
+    for (i = 0; i < AO40_NROOTS; ++i)
+      reg[i] = _mm256_setzero_si256();
+    for (j = 0; j < AO40_ENC_WORD; ++j) {
+      fb = _mm256_xor_si256(_mm256_load_si256((const __m256i *)(col[j] + l)), reg[0]);
+      lo = _mm256_and_si256(fb, mask);
+      hi = _mm256_and_si256(_mm256_srli_epi16(fb, 4), mask);
+#pragma GCC unroll 32
+      for (i = 0; i < AO40_NROOTS-1; ++i)
+        reg[i] = reg[i+1];
+      reg[AO40_NROOTS-1] = fb;
+#pragma GCC unroll 16
+      for (i = 0; i < AO40_NROOTS/2; ++i) {
+        t = _mm256_xor_si256(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_enc_tab[i][0])), lo),
+                             _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ao40_enc_tab[i][1])), hi));
+        reg[i] = _mm256_xor_si256(reg[i], t);
+        if (i < AO40_NROOTS/2-1)
+          reg[AO40_NROOTS-2-i] = _mm256_xor_si256(reg[AO40_NROOTS-2-i], t);
+      }
+    }
+    for (i = 0; i < AO40_NROOTS; ++i)
+      _mm256_store_si256((__m256i *)(par[i] + l), reg[i]);
+  }
+}
+
+AO40_TARGET("avx512bw")
+static void ao40_enc_parity_avx512bw(const uint8_t (*col)[AO40_ENC_LANES], uint8_t (*par)[AO40_ENC_LANES], int lanes) {
+  const __m512i mask = _mm512_set1_epi8(0x0f);
+  __m512i reg[AO40_NROOTS], fb, lo, hi, t;
+  int l, i, j;
+
+  for (l = 0; l < lanes; l += 64) {
+    for (i = 0; i < AO40_NROOTS; ++i)
+      reg[i] = _mm512_setzero_si512();
+    for (j = 0; j < AO40_ENC_WORD; ++j) {
+      fb = _mm512_xor_si512(_mm512_load_si512((const void *)(col[j] + l)), reg[0]);
+      lo = _mm512_and_si512(fb, mask);
+      hi = _mm512_and_si512(_mm512_srli_epi16(fb, 4), mask);
+#pragma GCC unroll 32
+      for (i = 0; i < AO40_NROOTS-1; ++i)
+        reg[i] = reg[i+1];
+      reg[AO40_NROOTS-1] = fb;
+#pragma GCC unroll 16
+      for (i = 0; i < AO40_NROOTS/2; ++i) {
+        t = _mm512_xor_si512(_mm512_shuffle_epi8(_mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)ao40_enc_tab[i][0])), lo),
+                             _mm512_shuffle_epi8(_mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)ao40_enc_tab[i][1])), hi));
+        reg[i] = _mm512_xor_si512(reg[i], t);
+        if (i < AO40_NROOTS/2-1)
+          reg[AO40_NROOTS-2-i] = _mm512_xor_si512(reg[AO40_NROOTS-2-i], t);
+      }
+    }
+    for (i = 0; i < AO40_NROOTS; ++i)
+      _mm512_store_si512((void *)(par[i] + l), reg[i]);
+  }
+}
+
+/* Kernel per level of ao40_cpu.h, 0: frame by frame */
+static const ao40_enc_parity_t ao40_enc_parity[AO40_KERNEL_COUNT] = {
+  0,  // AO40_KERNEL_SCALAR
+  0,  // AO40_KERNEL_SSE2
+  ao40_enc_parity_ssse3,
+  ao40_enc_parity_avx2,
+  ao40_enc_parity_avx512bw
+};
+
+/* Tables before main(), like the kernel level in ao40_cpu.c */
+__attribute__ ((constructor))
+static void ao40_enc_batch_init(void) {
+  uint8_t g;
+  int i, x;
+
+  for (i = 0; i < AO40_NROOTS/2; ++i) {
+    g = AO40_ALPHA_TO[AO40_RS_GENPOLY[AO40_NROOTS-1-i]];
+    for (x = 0; x < 16; ++x) {
+      ao40_enc_tab[i][0][x] = ao40_gf_mul(g, (uint8_t)x);
+      ao40_enc_tab[i][1][x] = ao40_gf_mul(g, (uint8_t)(x << 4));
+    }
+  }
+}
+
+/* Up to AO40_ENC_BATCH frames, 2m words: word k of frame f in lane 2f+k */
+static void ao40_enc_round(ao40_enc_parity_t parity_kernel, const uint8_t *const data[], uint8_t *const encoded[], int m) {
+  uint8_t col[AO40_ENC_WORD][AO40_ENC_LANES] __attribute__ ((aligned (64)));
+  uint8_t par[AO40_NROOTS][AO40_ENC_LANES] __attribute__ ((aligned (64)));
+  uint8_t parity[2][AO40_NROOTS];
+  struct ao40_encoder e;
+  int f, i, j;
+
+  memset(col, 0, sizeof(col));  // the unused lanes, for tidiness only
+  for (f = 0; f < m; ++f) {
+    for (j = 0; j < AO40_ENC_WORD; ++j) {
+      col[j][2*f] = data[f][2*j];
+      col[j][2*f+1] = data[f][2*j+1];
+    }
+  }
+  parity_kernel((const uint8_t (*)[AO40_ENC_LANES])col, par, 2*m);
+
+  for (f = 0; f < m; ++f) {
+    for (i = 0; i < AO40_NROOTS; ++i) {
+      parity[0][i] = par[i][2*f];
+      parity[1][i] = par[i][2*f+1];
+    }
+    encode_data_ao40_parity_r(&e, data[f], (const uint8_t (*)[AO40_NROOTS])parity, encoded[f]);
+  }
+}
+
+#endif /* AO40_ENC_KERNELS */
+
+void encode_data_ao40_batch(const uint8_t *const data[], uint8_t *const encoded[], int n) {
+  struct ao40_encoder e;
+  int i, m;
+#ifdef AO40_ENC_KERNELS
+  const ao40_enc_parity_t parity_kernel = ao40_enc_parity[ao40_get_kernel()];
+
+  if (parity_kernel != 0) {
+    while (n > 0) {
+      m = (n < AO40_ENC_BATCH) ? n : AO40_ENC_BATCH;
+      ao40_enc_round(parity_kernel, data, encoded, m);
+      data += m;
+      encoded += m;
+      n -= m;
+    }
+    return;
+  }
+#endif
+  (void)m;
+  for (i = 0; i < n; ++i)
+    encode_data_ao40_r(&e, data[i], encoded[i]);
+}
+
+#ifdef AO40_ENABLE_THREADS
+struct ao40_enc_job {
+  const uint8_t *const *data;
+  uint8_t *const *encoded;
+  int n;
+  int next;  // first frame no thread has taken yet
+};
+
+/* Takes AO40_ENC_BATCH frames at a time until none are left */
+static void *ao40_enc_worker(void *arg) {
+  struct ao40_enc_job *job = arg;
+  int i, m;
+
+  while ((i = __atomic_fetch_add(&job->next, AO40_ENC_BATCH, __ATOMIC_RELAXED)) < job->n) {
+    m = (job->n - i < AO40_ENC_BATCH) ? job->n - i : AO40_ENC_BATCH;
+    encode_data_ao40_batch(job->data + i, job->encoded + i, m);
+  }
+  return 0;
+}
+
+void encode_data_ao40_mt(const uint8_t *const data[], uint8_t *const encoded[], int n, int threads) {
+  struct ao40_enc_job job = { data, encoded, n, 0 };
+  pthread_t *tid;
+  int i, started;
+
+  if (threads <= 0)
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > (n + AO40_ENC_BATCH - 1) / AO40_ENC_BATCH)
+    threads = (n + AO40_ENC_BATCH - 1) / AO40_ENC_BATCH;
+  if (threads < 2 || (tid = malloc((size_t)(threads - 1) * sizeof(*tid))) == 0) {
+    ao40_enc_worker(&job);
+    return;
+  }
+
+  // this thread is one of them; one that fails to start just leaves more to the rest
+  started = 0;
+  for (i = 1; i < threads; ++i) {
+    if (pthread_create(&tid[started], 0, ao40_enc_worker, &job) == 0)
+      ++started;
+  }
+  ao40_enc_worker(&job);
+  for (i = 0; i < started; ++i)
+    pthread_join(tid[i], 0);
+  free(tid);
+}
+#endif /* AO40_ENABLE_THREADS */
@@ -0,0 +1,105 @@
+/*
+ * Output formats of the AO-40 encoder: the packed frame of
+ * encode_data_ao40() unpacked to one byte, int8_t or float per symbol
+ *
+ * With SSE2 two frame bytes at a time become 16 lanes: each lane gets
+ * the byte of its half and masks out the bit it stands for, the compare
+ * turns that into 0 or 0xff, and the format is built from the mask
+ * without a branch.
+ *
+ * The SSE2 path is chosen at compile time, not through the kernel level
+ * of ao40_cpu.h: SSE2 is part of the x86-64 baseline, so every x86-64 build
+ * has it, and these stages only stream one frame through memory, which
+ * wider vectors would not speed up enough to pay for a dispatch. 32-bit
+ * x86 builds without -msse2 take the scalar loops.
+ */
+
+#include <stdint.h>
+#include "ao40_enc.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+#if AO40_CODE_LENGTH % 2
+#error "the SSE2 output stages take the frame two bytes at a time"
+#endif
+
+/* Lane i of the 16 picks bit 7 - (i & 7) (MSB first) or i & 7 of its byte */
+static inline __m128i ao40_out_sel(int order) {
+  if (order == AO40_LSB_FIRST)
+    return _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  return _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+}
+
+/* Symbols of p[0] in lanes 0-7 and of p[1] in lanes 8-15, 0xff for a 1 */
+static inline __m128i ao40_out_mask(const uint8_t *p, __m128i sel) {
+  __m128i v = _mm_cvtsi32_si128(p[0] | (p[1] << 8));
+
+  v = _mm_unpacklo_epi8(v, v);
+  v = _mm_unpacklo_epi16(v, v);
+  v = _mm_unpacklo_epi32(v, v);
+  return _mm_cmpeq_epi8(_mm_and_si128(v, sel), sel);
+}
+#else
+static inline int ao40_out_bit(const uint8_t *encoded, int i, int order) {
+  return (encoded[i >> 3] >> ((order == AO40_LSB_FIRST) ? (i & 7) : 7 - (i & 7))) & 1;
+}
+#endif
+
+void ao40_unpack_bits(const uint8_t encoded[AO40_CODE_LENGTH], uint8_t bits[AO40_CODE_BITS], int order) {
+  int i;
+#ifdef __SSE2__
+  const __m128i sel = ao40_out_sel(order), one = _mm_set1_epi8(1);
+
+  for (i = 0; i < AO40_CODE_LENGTH; i += 2)
+    _mm_storeu_si128((__m128i *)(bits + 8*i), _mm_and_si128(ao40_out_mask(encoded + i, sel), one));
+#else
+  for (i = 0; i < AO40_CODE_BITS; ++i)
+    bits[i] = (uint8_t)ao40_out_bit(encoded, i, order);
+#endif
+}
+
+void ao40_unpack_s8(const uint8_t encoded[AO40_CODE_LENGTH], int8_t syms[AO40_CODE_BITS], int8_t amp, int order) {
+  int i;
+#ifdef __SSE2__
+  const __m128i sel = ao40_out_sel(order);
+  __m128i zero, flip;
+#endif
+
+  if (amp < 1)
+    amp = 1;  // -128 has no +amp, and amp <= 0 would flip the polarity
+#ifdef __SSE2__
+  zero = _mm_set1_epi8((int8_t)-amp);
+  flip = _mm_set1_epi8((int8_t)(amp ^ -amp));
+
+  // -amp, with the bits that make +amp of it flipped where the mask is set
+  for (i = 0; i < AO40_CODE_LENGTH; i += 2)
+    _mm_storeu_si128((__m128i *)(syms + 8*i), _mm_xor_si128(zero, _mm_and_si128(ao40_out_mask(encoded + i, sel), flip)));
+#else
+  for (i = 0; i < AO40_CODE_BITS; ++i)
+    syms[i] = ao40_out_bit(encoded, i, order) ? amp : (int8_t)-amp;
+#endif
+}
+
+void ao40_unpack_float(const uint8_t encoded[AO40_CODE_LENGTH], float syms[AO40_CODE_BITS], int order) {
+  int i;
+#ifdef __SSE2__
+  const __m128i sel = ao40_out_sel(order);
+  const __m128i minus_one = _mm_set1_epi32((int)0xbf800000), sign = _mm_set1_epi32((int)0x80000000);
+  __m128i m, h;
+
+  // -1.0f and +1.0f differ in the sign bit only
+  for (i = 0; i < AO40_CODE_LENGTH; i += 2) {
+    m = ao40_out_mask(encoded + i, sel);
+    h = _mm_unpacklo_epi8(m, m);
+    _mm_storeu_ps(syms + 8*i,      _mm_castsi128_ps(_mm_xor_si128(minus_one, _mm_and_si128(_mm_unpacklo_epi16(h, h), sign))));
+    _mm_storeu_ps(syms + 8*i + 4,  _mm_castsi128_ps(_mm_xor_si128(minus_one, _mm_and_si128(_mm_unpackhi_epi16(h, h), sign))));
+    h = _mm_unpackhi_epi8(m, m);
+    _mm_storeu_ps(syms + 8*i + 8,  _mm_castsi128_ps(_mm_xor_si128(minus_one, _mm_and_si128(_mm_unpacklo_epi16(h, h), sign))));
+    _mm_storeu_ps(syms + 8*i + 12, _mm_castsi128_ps(_mm_xor_si128(minus_one, _mm_and_si128(_mm_unpackhi_epi16(h, h), sign))));
+  }
+#else
+  for (i = 0; i < AO40_CODE_BITS; ++i)
+    syms[i] = ao40_out_bit(encoded, i, order) ? 1.0f : -1.0f;
+#endif
+}